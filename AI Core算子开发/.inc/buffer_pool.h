@@ -0,0 +1,50 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#ifndef BUFFER_POOL_H_
+#define BUFFER_POOL_H_
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#define BUFFER_MAX_BYTES (1ULL << 32)  // 4 GiB, custom::custom_op_run takes 32-bit output sizes
+
+// Reusable memory blocks of CUSTOMEngine output readback buffers.
+// A released block goes back to the free list of its size and is handed to the next
+// request asking for that size; idle blocks beyond maxIdleBytes are freed instead.
+// Shared by all engine threads.
+class BufferPool
+{
+public:
+    explicit BufferPool(uint64_t maxIdleBytes);
+
+    // size bytes, 64 byte aligned and not cleared, back to the pool when the last
+    // copy of the pointer goes. nullptr if size is 0, too large or out of memory.
+    std::shared_ptr<char> Acquire(uint64_t size);
+
+private:
+    // outlives the pool while blocks are still out
+    struct FreeLists
+    {
+        explicit FreeLists(uint64_t maxIdleBytes) : maxIdleBytes(maxIdleBytes) {}
+        ~FreeLists();
+        char* Take(uint64_t blockSize);
+        void Release(char* block, uint64_t blockSize);
+
+        std::mutex mutex;
+        std::map<uint64_t, std::vector<char*> > blocks;  // by block size
+        uint64_t idleBytes = 0;
+        uint64_t maxIdleBytes;
+    };
+
+    std::shared_ptr<FreeLists> freeLists;
+};
+
+#endif
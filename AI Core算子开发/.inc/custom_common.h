@@ -19,6 +19,7 @@
 #include <unistd.h>
 #include <vector>
 #include <stdint.h>
+#include "input_generator.h"
 
 #include "cereal/cereal.hpp"
 #include "cereal/types/unordered_map.hpp"
@@ -31,18 +32,95 @@ using namespace std;
 
 struct CustomFileBlob
 {
-    uint32_t size;
+    uint64_t size;
     std::shared_ptr<char> data;
 };
 
 
+// which outputs CUSTOMEngine sends back and the host writes to the output files
+enum ReturnOutputs
+{
+    RETURN_OUTPUTS_ALWAYS,
+    RETURN_OUTPUTS_ON_FAIL,  // only outputs that failed the compare, or all if nothing is compared
+    RETURN_OUTPUTS_NEVER
+};
+
+// dataTypeList codes, FP32 and FP16 are the ones custom::custom_op_compare knows
+enum CompareDataType
+{
+    COMPARE_FP32,
+    COMPARE_FP16,
+    COMPARE_INT8,
+    COMPARE_INT32,
+    COMPARE_BF16
+};
+
+#define COMPARE_ULP_BUCKETS 7
+#define COMPARE_MISMATCH_NUM 8
+
+// why an output failed, gathered in the same pass as the compare result
+struct CompareStats
+{
+    uint64_t elemNum = 0;
+    uint64_t deviated = 0;     // elements over precisionDeviation
+    double maxAbsError = 0;    // over elements that are not NaN
+    double maxRelError = 0;    // abs error / |expect|, inf if expect is 0
+    // elements at 0, 1, 2-3, 4-15, 16-255, 256-65535 and more ULPs (units of the dtype,
+    // plain difference for integers), a NaN against a number counts as the last bucket
+    vector<uint64_t> ulpHistogram;
+    vector<uint64_t> firstMismatches;  // indices of up to COMPARE_MISMATCH_NUM deviated elements
+};
+
+// us CUSTOMEngine spent on each step of one request, the time inside custom::custom_op_run
+// is CustomOutput::opRunTime. Outputs read back or compared in parallel add up their threads.
+// The SendData of the response is not in it, a response cannot time its own send.
+struct StageTiming
+{
+    double deserialize = 0;    // cereal loading the CustomInfo, chunk messages not included
+    double inputStaging = 0;   // inputs generated, taken from chunks and written to scratch files
+    double binaryStaging = 0;  // kernel and config blobs resolved and written to scratch files
+    double readback = 0;       // outputs read from their scratch files into memory
+    double compare = 0;        // device compare against the expect tensors
+};
+
+// the list a chunk message is part of
+enum ChunkRole
+{
+    CHUNK_INPUT,  // inputList
+    CHUNK_EXPECT  // expectFileList
+};
+
+// chain mode: a kernel run inside the same request after the previous stage
+struct ChainStage
+{
+    string name = "";
+    int32_t type = 0;
+    CustomFileBlob binFile;
+    uint64_t binFileHash = 0;  // see CustomInfo::binFileHash
+    vector<uint64_t> outputSizeList;
+    // input j is output inputLinkList[j] of the previous stage, or inputList[j] if the link is -1
+    vector<int32_t> inputLinkList;
+    vector<CustomFileBlob> inputList;
+    vector<uint64_t> inputSizeList;      // see CustomInfo::inputSizeList, chunks carry chunkStage
+    vector<uint64_t> workspaceSizeList;  // see CustomInfo::workspaceSizeList
+};
+
+// an intermediate output returned after the final outputs, stage 0 is CustomInfo itself
+struct ChainTap
+{
+    int32_t stage;
+    int32_t output;
+};
+
 struct CustomInfo
 {
+    uint32_t requestId = 0;  // echoed in CustomOutput to match results of requests in flight
     string name = "";
     int32_t type = 0;
-    vector<uint32_t> outputSizeList;
+    vector<uint64_t> outputSizeList;
     CustomFileBlob binFile;
     vector<CustomFileBlob> inputList;
+    vector<InputGenerator> inputGeneratorList;  // empty, or one per input, GEN_NONE inputs come from inputList
     CustomFileBlob configFile;
     
      // compare related feilds
@@ -50,13 +128,46 @@ struct CustomInfo
     float precisionDeviation     = 0.1;
     float statisticalDiscrepancy = 0.1;
     vector<CustomFileBlob> expectFileList;
+    int32_t returnOutputs = RETURN_OUTPUTS_ALWAYS;
+
+    // chunk streaming related fields, inputs and expect tensors larger than the chunk size are
+    // sent ahead of the run request as chunk messages and left empty in their lists
+    int32_t chunkInput = -1;  // index carried by a chunk message, -1 for a run request
+    int32_t chunkRole = CHUNK_INPUT;  // ChunkRole, the list chunkInput indexes
+    int32_t chunkStage = 0;  // chain stage of an input chunk, s for chainList[s - 1].inputList
+    uint64_t chunkOffset = 0;
+    vector<uint64_t> inputSizeList;
+    vector<uint64_t> expectSizeList;
+
+    // chain mode, the outputs of the last stage replace the outputs of this kernel
+    vector<ChainStage> chainList;
+    vector<ChainTap> tapList;
+
+    // kernel cache related fields, HashBytes of binFile and configFile or 0. Once CUSTOMEngine
+    // has a blob the host only sends its hash and leaves the blob empty.
+    uint64_t binFileHash = 0;
+    uint64_t configFileHash = 0;
+
+    int32_t scratchBacking = 0;  // ScratchBacking of the files CUSTOMEngine hands to the op runtime
+
+    // bytes of each scratch memory custom::custom_op_run allocates for the kernel on every run
+    vector<uint64_t> workspaceSizeList;
+
+    double deserializeTime = 0;  // us cereal spent loading this message, set on the receiving side only
 };
 
 struct CustomOutput
 {
+    uint32_t requestId = 0;
     uint32_t size;
-    vector<CustomFileBlob> outputList;
+    vector<CustomFileBlob> outputList;  // one blob per output, outputs not returned have no data
     vector<int32_t> compareResultList;
+    double opRunTime = 0;  // us spent inside custom::custom_op_run
+    bool kernelMissing = false;  // a hash-only kernel or config was not cached, resend with the blobs
+    vector<CompareStats> compareStatsList;  // one per compareResultList entry
+    StageTiming timing;
+    vector<uint64_t> missingKernels;  // hashes of the kernel and config blobs behind kernelMissing
+    bool failed = false;  // the request or one of its chunks failed on the engine, nothing else is set
 };
 
 /**
@@ -79,9 +190,18 @@ HIAI_DEF_ERROR_CODE(USE_DEFINE_ERROR, HIAI_INFO, HIAI_IDE_INFO, \
     "Custom Operator runnning ok");
 HIAI_DEF_ERROR_CODE(USE_DEFINE_ERROR, HIAI_WARNING, HIAI_IDE_WARNING, \
     "Custom Operator runnning warning");
-char* ReadFile(const char *fileName, uint32_t *fileSize);
+char* ReadFile(const char *fileName, uint64_t *fileSize);
+
+// map a regular file into fileBlob without copying, pipes and devices are read to the end instead
+int32_t LoadFileBlob(const char *fileName, CustomFileBlob& fileBlob);
+
+int32_t  WriteFile(const char* file_name, const char* buffer, uint64_t size);
+
+// write size bytes at offset of fileName, the file is truncated first if truncate is set
+int32_t  WriteFileAt(const char* fileName, const char* buffer, uint64_t size, uint64_t offset, bool truncate);
 
-int32_t  WriteFile(const char* file_name, const char* buffer, uint32_t size);
+// 64-bit content hash (XXH64), chain calls by passing the previous hash as seed
+uint64_t HashBytes(const char* data, uint64_t size, uint64_t seed);
 
 #endif
 
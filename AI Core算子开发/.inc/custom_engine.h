@@ -11,8 +11,10 @@
 #include <unistd.h>
 #include <vector>
 #include <stdint.h>
+#include <map>
 #include "custom/custom_op.h"
 #include "custom_common.h"
+#include "op_executor.h"
 
 #include "cereal/cereal.hpp"
 #include "cereal/types/unordered_map.hpp"
@@ -29,6 +31,7 @@
 
 #define DEST_ENGINE_INPUT_SIZE 1
 #define DEST_ENGINE_OUTPUT_SIZE 1
+
 using hiai::Engine;
 
 // Framework Engine
@@ -40,6 +43,12 @@ public:
     * @[in]: ?????????????????????????????????????????????
     */
     HIAI_DEFINE_PROCESS(CUSTOM_ENGINE_INPUT_SIZE, CUSTOM_ENGINE_OUTPUT_SIZE)
+private:
+    // answers a request that failed, so the host frees its in-flight slot instead of waiting for it
+    HIAI_StatusT SendFailure(uint32_t requestId);
+
+    // shared by the engine threads of graph.config thread_num
+    OpExecutor executor{CreateOpRuntime()};
 };
 class SrcEngine : public Engine {
     /**
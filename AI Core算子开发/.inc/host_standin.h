@@ -0,0 +1,51 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#ifndef HOST_STANDIN_H_
+#define HOST_STANDIN_H_
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// CPU stand-ins for the sample kernels, so sweeps run on machines without a device.
+// Tensors are GEN_FLOAT16 or GEN_FLOAT32 (GeneratorElemType), math is done in double.
+
+// operator/reduction.py: the input is flattened to shape[:axis] + [prod(shape[axis:])] and the
+// last dim is summed after SUM/ASUM/SUMSQ/MEAN, scaled by coeff, MEAN also divides by the reduced size
+int32_t HostReduction(const std::vector<int64_t>& shape, int32_t axis, const std::string& op, float coeff,
+                      int32_t elemType, const char* input, char* output);
+
+struct ConvShape
+{
+    int64_t n;
+    int64_t cin;
+    int64_t h;
+    int64_t w;
+    int64_t cout;
+    int64_t kh;
+    int64_t kw;
+    int64_t stride;
+    int64_t pad;
+
+    int64_t OutH() const
+    {
+        return (h + 2 * pad - kh) / stride + 1;
+    }
+    int64_t OutW() const
+    {
+        return (w + 2 * pad - kw) / stride + 1;
+    }
+};
+
+// dims in SweepSpec order: N, Cin, H, W, Cout, KH, KW, stride, pad
+ConvShape MakeConvShape(const std::vector<int64_t>& dims);
+
+// direct convolution, input [N, Cin, H, W], weight [Cout, Cin, KH, KW], output [N, Cout, OutH, OutW]
+int32_t HostConv2d(const ConvShape& shape, int32_t elemType, const char* input, const char* weight, char* output);
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#ifndef INPUT_GENERATOR_H_
+#define INPUT_GENERATOR_H_
+#include <stdint.h>
+
+enum GeneratorDistribution
+{
+    GEN_NONE,      // the input is a file shipped in CustomInfo::inputList
+    GEN_UNIFORM,   // [param0, param1)
+    GEN_NORMAL,    // mean param0, stddev param1
+    GEN_CONSTANT,  // param0
+    GEN_RAMP       // param0 + i * param1
+};
+
+enum GeneratorElemType
+{
+    GEN_FLOAT32,
+    GEN_FLOAT16,
+    GEN_INT32,
+    GEN_INT8,
+    GEN_UINT8
+};
+
+// Synthetic input descriptor, CUSTOMEngine expands it on the device instead of
+// receiving the data. Element i only depends on seed and i, so the host
+// reproduces exactly the same stream for golden data.
+struct InputGenerator
+{
+    int32_t distribution = GEN_NONE;
+    int32_t elemType = GEN_FLOAT32;
+    uint64_t elemNum = 0;
+    uint64_t seed = 0;
+    float param0 = 0;
+    float param1 = 0;
+};
+
+// IEEE half precision conversions shared by the generator, comparator and host stand-in
+float HalfToFloat(uint16_t half);
+uint16_t FloatToHalf(float value);
+
+// bytes of one element, 0 for an unknown elemType
+uint32_t GeneratorElemSize(int32_t elemType);
+
+// fill out with elements [firstElem, firstElem + elemNum) of the stream
+int32_t GenerateElements(const InputGenerator& generator, uint64_t firstElem, uint64_t elemNum, char* out);
+
+// expand the whole stream into fileName block by block
+int32_t WriteGeneratedInput(const char* fileName, const InputGenerator& generator);
+
+#endif
@@ -0,0 +1,46 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#ifndef KERNEL_CACHE_H_
+#define KERNEL_CACHE_H_
+#include <stdint.h>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "op_runtime.h"
+
+// Kernel binaries and configs CUSTOMEngine has received, by content hash. An entry is
+// staged for the runtime once (e.g. its scratch file is written) and reused by every
+// later request, least recently used entries are dropped beyond maxBytes.
+class KernelCache
+{
+public:
+    explicit KernelCache(uint64_t maxBytes) : maxBytes(maxBytes) {}
+
+    // the buffer of hash, nullptr if it is not cached
+    std::shared_ptr<OpBuffer> Get(uint64_t hash);
+    // cache blob under hash, staged as a file of backing if toFile, nullptr if blob does not match hash;
+    // the file stays on the backing of the request that cached it
+    std::shared_ptr<OpBuffer> Put(uint64_t hash, const CustomFileBlob& blob, bool toFile, int32_t backing);
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<OpBuffer> buffer;
+        std::list<uint64_t>::iterator lru;
+    };
+
+    uint64_t maxBytes;
+    uint64_t bytes = 0;
+    std::map<uint64_t, Entry> entries;
+    std::list<uint64_t> lruList;  // most recently used first
+    std::mutex mutex;
+};
+
+#endif
@@ -0,0 +1,148 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#ifndef OP_DISPATCHER_H_
+#define OP_DISPATCHER_H_
+#include <hiaiengine/graph.h>
+#include "hiaiengine/api.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <set>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "custom_common.h"
+#include "output_writer.h"
+#include "result_cache.h"
+#include "tensor_compare.h"
+#include "worker_pool.h"
+
+static const uint32_t GRAPH_ID = 100;
+static const uint32_t SRC_ENGINE_ID = 1000;
+static const uint32_t SRC_PORT_ID = 0;
+static const uint32_t DST_ENGINE_ID = 1002;
+static const uint32_t DEST_PORT_ID = 0;
+static const int MAX_SLEEP_TIMER = 30 * 60;
+static const uint32_t COMPARE_THREADS = 4;  // host compare threads shared by all cases
+
+// one op_run case ready to be sent
+struct RunCase
+{
+    uint32_t index = 0;
+    std::shared_ptr<CustomInfo> customInfo;
+    std::vector<std::string> outputFileList;
+    bool hostCompare = false;  // keep expect tensors on the host and compare the returned outputs here
+};
+
+struct CaseResult
+{
+    bool valid = false;  // false if the case failed, timed out or the device disconnected
+    std::vector<int32_t> compareResultList;
+    std::vector<CompareStats> compareStatsList;  // why each compared output passed or failed
+    double latencyMs = 0;  // send to receive
+    double opRunTime = 0;  // us spent inside custom::custom_op_run
+    StageTiming timing;    // where the device spent the request, see CustomOutput
+    bool cached = false;   // served from the result cache, the device did not run
+};
+
+enum DispatchPolicy
+{
+    DISPATCH_ROUND_ROBIN,
+    DISPATCH_LEAST_LOADED
+};
+
+// Host side dispatcher over one or more CUSTOMEngine replicas, each replica is
+// a copy of graph 100 with its own graph id (GRAPH_ID + replica).
+class OpDispatcher
+{
+public:
+    // inFlightLimit bounds the requests queued on each replica, further cases are
+    // loaded and serialized on the host while earlier ones run on the device
+    OpDispatcher(uint32_t replicaNum, uint32_t inFlightLimit, DispatchPolicy policy, uint64_t chunkSize);
+
+    // HIAI_Init, create every replica graph and hook up the receivers
+    HIAI_StatusT Start(const std::string& graphConfigFile, bool watchDisconnect);
+    void Stop();
+
+    // look up submitted cases in resultCache first and store device results in it
+    void SetResultCache(ResultCache* resultCache)
+    {
+        this->resultCache = resultCache;
+    }
+
+    // hand a case to a replica, blocks while every replica is busy, call from one thread at a time,
+    // useCache false always runs the case on the device and leaves the cache untouched
+    int Submit(const RunCase& runCase, bool useCache = true);
+    // block until the result of case index arrives
+    bool Wait(uint32_t index, CaseResult& result);
+
+    void OnResult(uint32_t replica, const std::shared_ptr<CustomOutput>& customOutput,
+                  std::chrono::steady_clock::time_point recvTime);
+    void OnDisconnect();
+
+private:
+    struct PendingCase
+    {
+        uint32_t requestId;
+        uint32_t index;
+        std::vector<std::string> outputFileList;
+        std::chrono::steady_clock::time_point sendTime;
+        uint64_t cacheKey;
+        bool storeResult;  // put the device result into resultCache
+        std::shared_ptr<CustomInfo> compareInfo;  // expect tensors for host compare, nullptr otherwise
+        int32_t returnOutputs;                    // ReturnOutputs policy for writing the output files
+        std::shared_ptr<CustomInfo> request;      // kept to resend the kernels if CUSTOMEngine lost them
+        bool hostCompare;
+        bool resent;
+    };
+
+    struct Replica
+    {
+        uint32_t graphId;
+        std::deque<PendingCase> inFlight;
+        std::set<uint64_t> kernels;  // hashes of the kernel and config blobs sent to this replica, minus evicted ones
+    };
+
+    bool HasFreeReplica() const;
+    uint32_t PickReplica();
+    // fullKernels sends every kernel blob, otherwise blobs the replica has already got go as hash only
+    int SendCustomInfo(uint32_t replica, uint32_t requestId, std::shared_ptr<CustomInfo> customInfo,
+                       bool hostCompare, bool fullKernels);
+    int SendChunks(const std::shared_ptr<hiai::Graph>& graph, hiai::EnginePortID& engine_id, const CustomInfo& request,
+                   int32_t role, int32_t stage, uint32_t index, CustomFileBlob& blob);
+    bool DropInFlight(uint32_t replica, uint32_t requestId, PendingCase& pending);
+    void ShareKernel(uint32_t replica, CustomFileBlob& blob, uint64_t& hash, bool fullKernels);
+    void WriteVertifyResult(uint64_t sequence, const PendingCase& pending, const CustomOutput& customOutput);
+    void DeliverResult(const PendingCase& pending, const std::shared_ptr<CustomOutput>& customOutput,
+                       std::chrono::steady_clock::time_point recvTime, bool cached);
+    void PersistResult(const PendingCase& pending, const std::shared_ptr<CustomOutput>& customOutput,
+                       uint64_t sequence, CaseResult result);
+    void PublishResult(uint32_t index, const CaseResult& result);
+
+    DispatchPolicy policy;
+    uint64_t chunkSize;
+    uint32_t inFlightLimit;
+    uint32_t nextReplica = 0;
+    uint32_t nextRequestId = 1;
+    bool disconnected = false;
+    ResultCache* resultCache = nullptr;
+    std::vector<Replica> replicas;
+    std::map<uint32_t, CaseResult> results;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::mutex vertifyMutex;
+    uint64_t nextSequence = 1;     // delivery order, vertifyResult.txt always shows the latest case
+    uint64_t vertifySequence = 0;  // case last written to vertifyResult.txt
+    WorkerPool comparePool{COMPARE_THREADS};
+    // declared last, so its threads are joined before anything they touch is destroyed
+    OutputWriter writer;
+};
+
+#endif
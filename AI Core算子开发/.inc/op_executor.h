@@ -0,0 +1,87 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#ifndef OP_EXECUTOR_H_
+#define OP_EXECUTOR_H_
+#include <stdint.h>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "custom_common.h"
+#include "kernel_cache.h"
+#include "op_runtime.h"
+#include "buffer_pool.h"
+#include "worker_pool.h"
+
+#define KERNEL_CACHE_BYTES (512ULL * 1024 * 1024)
+#define STAGE_WAIT_SECONDS 60
+#define OUTPUT_ARENA_BYTES (512ULL * 1024 * 1024)    // idle readback buffers kept for later requests
+#define PARALLEL_READBACK_BYTES (1ULL * 1024 * 1024)  // outputs of a request read back in parallel from this size on
+#define READBACK_THREADS 4  // readback threads shared by all engine threads, at most hardware_concurrency
+
+// Everything CUSTOMEngine does for a request besides receiving and sending it: resolve
+// the kernels, stage the inputs, run the chain, compare and read back. The buffers and
+// scratch files of a request belong to its Execute call, chunks are kept per request id,
+// so any number of engine threads may share one executor.
+class OpExecutor
+{
+public:
+    explicit OpExecutor(std::shared_ptr<OpRuntime> runtime) : runtime(runtime) {}
+
+    // write one chunk message straight into the input or expect file of its request
+    int32_t StageInputChunk(const CustomInfo& chunk);
+
+    /**
+     * @brief run one request
+     * @param customOutput filled with outputs, compare results and run time, or only
+     *        kernelMissing if a hash-only kernel is not cached
+     * @return 0 on success, -1 if the request failed
+     */
+    int32_t Execute(const CustomInfo& customInfo, CustomOutput& customOutput);
+
+private:
+    struct StagedInput
+    {
+        std::unique_ptr<ScratchFile> file;
+        uint64_t bytes = 0;  // received in chunks so far
+        bool failed = false;  // a chunk could not be staged, the run request fails at once
+    };
+    typedef std::tuple<uint32_t, int32_t, int32_t, int32_t> StageKey;  // request id, ChunkRole, chain stage, index
+
+    // kernel or config blob of a request, nullptr if only its hash was sent and it is not cached
+    std::shared_ptr<OpBuffer> ResolveKernelBlob(const CustomFileBlob& blob, uint64_t hash, const std::string& name,
+                                                int32_t backing);
+    // the input or expect tensor reassembled from chunks, waits for chunks still being written by other threads
+    std::shared_ptr<OpBuffer> TakeStagedInput(const StageKey& key, uint64_t size);
+    void DropStagedInputs(uint32_t requestId);
+    int32_t RunKernel(const OpKernel& kernel, const std::vector<std::shared_ptr<OpBuffer> >& inputs,
+                      const std::vector<std::string>& outputNames, const std::vector<uint64_t>& outputSizes,
+                      std::vector<std::shared_ptr<OpBuffer> >& outputs, double& opRunTime, StageTiming& timing);
+    int32_t PrepareInputs(const CustomInfo& customInfo, std::vector<std::shared_ptr<OpBuffer> >& inputs);
+    int32_t PrepareStageInputs(const CustomInfo& customInfo,
+                               std::vector< std::vector< std::shared_ptr<OpBuffer> > >& stageInputs);
+    int32_t PrepareExpects(const CustomInfo& customInfo, std::vector<CustomFileBlob>& expects);
+    int32_t CompareOutput(const CustomInfo& customInfo, uint32_t i, const CustomFileBlob& expectBlob,
+                          const CustomFileBlob& outputBlob, bool& compareRet, CompareStats& stats);
+
+    std::shared_ptr<OpRuntime> runtime;
+    KernelCache kernelCache{KERNEL_CACHE_BYTES};
+    // outputs read back into memory, recycled once the CustomOutput holding them is sent and dropped;
+    // repeated runs ask for the same sizes, so a block is only reused for its own size
+    BufferPool outputArena{OUTPUT_ARENA_BYTES};
+    WorkerPool readbackPool{READBACK_THREADS};
+    std::map<StageKey, StagedInput> stagedInputs;
+    std::mutex stageMutex;
+    std::condition_variable stageCv;
+};
+
+#endif
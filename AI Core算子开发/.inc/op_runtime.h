@@ -0,0 +1,108 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#ifndef OP_RUNTIME_H_
+#define OP_RUNTIME_H_
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "buffer_pool.h"
+#include "custom_common.h"
+#include "scratch_file.h"
+
+// One kernel operand in CUSTOMEngine. It is held in memory, in a scratch file, or both;
+// the other view is created on first use only. A buffer runtime therefore never touches
+// the filesystem, and the file runtime hands a stage output to the next stage as it is.
+class OpBuffer
+{
+public:
+    // memory backed, name is the scratch file File() creates if a runtime asks for a path
+    OpBuffer(const std::string& name, const CustomFileBlob& blob);
+    // backed by file, written by someone else, the file goes away with the buffer
+    static std::shared_ptr<OpBuffer> FromFile(std::unique_ptr<ScratchFile> file, uint64_t size);
+
+    uint64_t Size() const
+    {
+        return size;
+    }
+    bool HasFile() const
+    {
+        return file != nullptr;
+    }
+    // memory view, reads the file the first time into a block of pool if given; a tap and a
+    // final output may be one buffer read back from two threads
+    int32_t Memory(CustomFileBlob& blob, BufferPool* pool = nullptr);
+    // file view, writes the memory to a scratch file of backing the first time
+    int32_t File(std::string& path, int32_t backing);
+    void SetMemory(const CustomFileBlob& blob);
+
+private:
+    OpBuffer(const OpBuffer&) = delete;
+    OpBuffer& operator=(const OpBuffer&) = delete;
+
+    std::string name;
+    uint64_t size;
+    CustomFileBlob memory;
+    std::unique_ptr<ScratchFile> file;
+    std::mutex mutex;  // guards memory and file
+};
+
+// everything custom::custom_op_run needs besides the operands, the blobs usually come
+// from KernelCache and are already staged
+struct OpKernel
+{
+    std::string name;
+    int32_t type;
+    std::shared_ptr<OpBuffer> binFile;
+    std::shared_ptr<OpBuffer> configFile;  // C++ operators (type 2) only
+    std::vector<uint64_t> workspaceSizes;  // custom::custom_op_run allocates the workspaces itself
+    int32_t scratchBacking;  // ScratchBacking of the request, for every file staged or created by Run
+};
+
+// Executes one kernel from input buffers into output buffers.
+class OpRuntime
+{
+public:
+    virtual ~OpRuntime() {}
+
+    // true if Run needs file views, inputs are then staged as files right away
+    virtual bool NeedsFiles() const = 0;
+
+    /**
+     * @brief run kernel once
+     * @param outputNames scratch file name of each output, used if the runtime works on files
+     * @param outputs filled with one buffer per outputSizes entry
+     * @param opRunTime us spent in the kernel
+     * @return 0 on success, -1 on failure
+     */
+    virtual int32_t Run(const OpKernel& kernel, const std::vector<std::shared_ptr<OpBuffer> >& inputs,
+                        const std::vector<std::string>& outputNames, const std::vector<uint64_t>& outputSizes,
+                        std::vector<std::shared_ptr<OpBuffer> >& outputs, double& opRunTime) = 0;
+};
+
+// custom::custom_op_run of the DDK, which only takes paths: buffers are staged as scratch
+// files and the outputs stay file backed until somebody reads them. The DDK loads the
+// kernel from its path on every call, the staged kernel file is what stays alive.
+class FileOpRuntime : public OpRuntime
+{
+public:
+    bool NeedsFiles() const
+    {
+        return true;
+    }
+    int32_t Run(const OpKernel& kernel, const std::vector<std::shared_ptr<OpBuffer> >& inputs,
+                const std::vector<std::string>& outputNames, const std::vector<uint64_t>& outputSizes,
+                std::vector<std::shared_ptr<OpBuffer> >& outputs, double& opRunTime);
+};
+
+// the runtime CUSTOMEngine uses, a buffer based one goes here once the device runtime takes memory
+std::shared_ptr<OpRuntime> CreateOpRuntime();
+
+#endif
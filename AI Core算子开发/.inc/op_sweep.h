@@ -0,0 +1,28 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#ifndef OP_SWEEP_H_
+#define OP_SWEEP_H_
+#include <stdint.h>
+#include <string>
+
+class OpDispatcher;
+
+/**
+ * @brief run every shape of a sweep spec (see SweepSpec) warmup + repeat times and write
+ *        <report>.csv and <report>.json with latency, effective bandwidth, FLOP/s and the
+ *        fraction of the attainable peak min(peakGflops, intensity * peakGBps) per shape
+ * @param dispatcher started dispatcher, nullptr times the host stand-in instead of the device
+ * @param configFile sent along with C++ operators (type 2)
+ * @param scratchBacking ScratchBacking of the device scratch files
+ * @return 0 if every shape ran, -1 otherwise, the report lists the failed shapes too
+ */
+int RunSweep(const std::string& specFile, OpDispatcher* dispatcher, const std::string& configFile,
+             int32_t scratchBacking);
+
+#endif
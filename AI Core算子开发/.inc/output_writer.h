@@ -0,0 +1,57 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#ifndef OUTPUT_WRITER_H_
+#define OUTPUT_WRITER_H_
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "custom_common.h"
+
+struct WriteJob
+{
+    std::string fileName;
+    CustomFileBlob data;  // kept alive until the file is written
+};
+
+// Background pool that persists results, so the HiAI receive callback returns at once.
+// Every file is written with one open and large pwrite calls, the files of a batch are
+// spread over the pool threads.
+class OutputWriter
+{
+public:
+    explicit OutputWriter(uint32_t threadNum);
+    // finishes everything queued before returning
+    ~OutputWriter();
+
+    // run task on a pool thread
+    void Post(std::function<void()> task);
+    // write every file of jobs, then call done on the pool thread finishing the last one,
+    // ok is false if any write failed
+    void WriteFiles(const std::vector<WriteJob>& jobs, std::function<void(bool ok)> done);
+    // block until the queue is empty and no task is running
+    void Drain();
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()> > tasks;
+    uint32_t running = 0;
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable taskCv;
+    std::condition_variable idleCv;
+};
+
+#endif
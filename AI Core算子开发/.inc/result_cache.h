@@ -0,0 +1,49 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#ifndef RESULT_CACHE_H_
+#define RESULT_CACHE_H_
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include "custom_common.h"
+
+enum CacheMode
+{
+    CACHE_USE,      // return stored results, run and store on a miss
+    CACHE_BYPASS,   // neither read nor write the cache
+    CACHE_REFRESH   // always run and overwrite the stored result
+};
+
+// On-disk CustomOutput cache keyed by the content of everything that decides
+// the result of a run: kernel, inputs, config, OpAttr, output sizes and the
+// compare settings.
+class ResultCache
+{
+public:
+    ResultCache(const std::string& cacheDir, CacheMode mode);
+
+    CacheMode Mode() const
+    {
+        return mode;
+    }
+
+    static uint64_t Key(const CustomInfo& customInfo);
+
+    // nullptr on a miss or when the mode does not read the cache
+    std::shared_ptr<CustomOutput> Load(uint64_t key);
+    void Store(uint64_t key, const CustomOutput& customOutput);
+
+private:
+    std::string FileName(uint64_t key) const;
+
+    std::string cacheDir;
+    CacheMode mode;
+};
+
+#endif
@@ -0,0 +1,55 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#ifndef SCRATCH_FILE_H_
+#define SCRATCH_FILE_H_
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+// where the scratch files handed to custom::custom_op_run live
+enum ScratchBacking
+{
+    SCRATCH_DISK,   // /tmp, whatever filesystem that is on the board
+    SCRATCH_TMPFS,  // SCRATCH_TMPFS_DIR, never written back to storage
+    SCRATCH_MEMFD   // anonymous memory from memfd_create, reached as /proc/self/fd/N
+};
+
+#define SCRATCH_DISK_DIR "/tmp/"
+#define SCRATCH_TMPFS_DIR "/dev/shm/op_run/"
+
+// "disk", "tmpfs" or "memfd", -1 for anything else
+int32_t ParseScratchBacking(const std::string& name);
+const char* ScratchBackingName(int32_t backing);
+
+// One empty scratch file, removed (or its memfd closed) with the object. Path() can be
+// opened, truncated and rewritten like any other file. Names get a process and sequence
+// prefix, so concurrent requests never share a file even if they ask for the same name.
+class ScratchFile
+{
+public:
+    // nullptr if backing is not available, e.g. memfd_create on an old kernel; CUSTOMEngine
+    // passes the backing of the request the file belongs to
+    static std::unique_ptr<ScratchFile> Create(const std::string& name, int32_t backing);
+    ~ScratchFile();
+
+    const std::string& Path() const
+    {
+        return path;
+    }
+
+private:
+    ScratchFile(const std::string& path, int fd) : path(path), fd(fd) {}
+    ScratchFile(const ScratchFile&) = delete;
+    ScratchFile& operator=(const ScratchFile&) = delete;
+
+    std::string path;
+    int fd;  // the memfd, -1 for files with a name
+};
+
+#endif
@@ -0,0 +1,37 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#ifndef TENSOR_COMPARE_H_
+#define TENSOR_COMPARE_H_
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "custom_common.h"
+#include "worker_pool.h"
+
+// In memory replacement of custom::custom_op_compare, used by CUSTOMEngine and the host.
+// An element deviates when |output - expect| > precisionDeviation * |expect|, when it is NaN on
+// one side only, or when either side is infinite and the two differ. The output passes while
+// the fraction of deviating elements is at most statisticalDiscrepancy.
+// dataType is a CompareDataType, the tensors are walked once with AVX2/F16C or NEON.
+// Returns -1 if the tensors can not be compared (size mismatch, unknown data type).
+int32_t CompareTensor(const CustomFileBlob& expect, const CustomFileBlob& output, int32_t dataType,
+                      float precisionDeviation, float statisticalDiscrepancy, bool& compareRet,
+                      CompareStats& stats);
+int32_t CompareTensor(const CustomFileBlob& expect, const CustomFileBlob& output, int32_t dataType,
+                      float precisionDeviation, float statisticalDiscrepancy, bool& compareRet);
+
+// one line summary of stats for logs and vertifyResult.txt
+std::string CompareStatsText(const CompareStats& stats);
+
+// compare the leading outputs with the expect tensors of customInfo, in parallel on pool
+void CompareOutputs(const CustomInfo& customInfo, const std::vector<CustomFileBlob>& outputList,
+                    std::vector<int32_t>& compareResultList, std::vector<CompareStats>& compareStatsList,
+                    WorkerPool& pool);
+
+#endif
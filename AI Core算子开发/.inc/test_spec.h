@@ -0,0 +1,118 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#ifndef TEST_SPEC_H_
+#define TEST_SPEC_H_
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "input_generator.h"
+
+// minimal JSON document, enough for op_run test specs
+struct JsonValue
+{
+    enum Type { JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT };
+    Type type = JSON_NULL;
+    bool boolean = false;
+    double number = 0;
+    std::string str;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue> > object;
+
+    // member lookup, nullptr if this is not an object or has no such key
+    const JsonValue* Find(const std::string& key) const;
+};
+
+int ParseJson(const std::string& text, JsonValue& root, std::string& errorMsg);
+
+struct TensorSpec
+{
+    std::string path = "";
+    std::vector<int64_t> shape;
+    std::string dtype = "float16";
+    int32_t dataType = 1;  // dataTypeList code of dtype
+    uint32_t elemSize = 2;
+    std::string layout = "ND";  // ND, NCHW, NHWC or NC1HWC0, checked against shape
+    uint64_t size = 0;  // bytes, product of shape * elemSize
+    std::string expect = "";  // outputs only, optional golden file
+    // inputs only, expanded on the device, path is then optional and receives the host copy of the stream
+    InputGenerator generator;
+    int32_t from = -1;  // chain stage inputs only, output of the previous stage fed into this input
+};
+
+// one kernel of a chain, runs on the outputs of the stage before it
+struct StageSpec
+{
+    std::string kernelName = "";
+    int32_t type = 2;
+    std::string binFile = "";
+    std::vector<TensorSpec> inputs;
+    std::vector<TensorSpec> outputs;
+    std::vector<uint64_t> workspaces;  // bytes of each kernel workspace, see CustomInfo::workspaceSizeList
+};
+
+// one op_run case: kernel, tensors and compare tolerances
+struct TestSpec
+{
+    std::string kernelName = "";
+    int32_t type = 2;
+    std::string binFile = "";
+    float precisionDeviation = 0.8;
+    float statisticalDiscrepancy = 0.8;
+    std::vector<TensorSpec> inputs;
+    std::vector<TensorSpec> outputs;
+    std::vector<uint64_t> workspaces;
+    // chain mode: every output path except those of the last stage is an optional tap,
+    // only the last stage outputs may have "expect"
+    std::vector<StageSpec> chain;
+};
+
+/**
+ * @brief parse a JSON test spec and check every size against its shape,
+ *        so a bad case is rejected before anything is sent to the device
+ * @return 0 on success, -1 on failure with the reason printed to stream
+ */
+int LoadTestSpec(const std::string& fileName, TestSpec& spec, FILE *stream);
+
+enum SweepKernel
+{
+    SWEEP_REDUCTION,  // operator/reduction.py, shape is the input shape
+    SWEEP_CONV        // 2D convolution, shape is [N, Cin, H, W, Cout, KH, KW, stride, pad]
+};
+
+// one kernel run over many shapes, see op_sweep.h
+struct SweepSpec
+{
+    int32_t kernel = SWEEP_REDUCTION;
+    std::string kernelName = "";  // "{shape}" is replaced by the dims joined with '_', e.g. 2_3_4
+    std::string binFile = "";     // same substitution, one compiled kernel per shape
+    int32_t type = 0;
+    std::string dtype = "float16";
+    uint32_t elemSize = 2;
+    InputGenerator generator;     // inputs are always generated, elemType and elemNum are set per shape
+    // reduction only
+    std::string op = "SUM";
+    int32_t axis = 0;
+    float coeff = 1;
+    std::vector<std::vector<int64_t> > shapes;  // "shapes" followed by the cartesian product of "grid"
+    uint32_t warmup = 1;
+    uint32_t repeat = 5;
+    double peakGflops = 0;  // 0 leaves the peak fraction out
+    double peakGBps = 0;
+    std::string report = "./output/sweep";  // report.csv and report.json are written
+};
+
+/**
+ * @brief parse a JSON sweep spec and check every shape against the kernel rules
+ * @return 0 on success, -1 on failure with the reason printed to stream
+ */
+int LoadSweepSpec(const std::string& fileName, SweepSpec& spec, FILE *stream);
+
+#endif
@@ -0,0 +1,53 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#ifndef WORKER_POOL_H_
+#define WORKER_POOL_H_
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of threads, started once and capped at hardware_concurrency, that run the
+// iterations of ParallelFor. The calling thread runs iterations too, so any number of
+// callers may share one pool and none of them waits on a pool busy with the others.
+class WorkerPool
+{
+public:
+    explicit WorkerPool(uint32_t maxThreads);
+    ~WorkerPool();
+
+    // task(0) .. task(count - 1) in any order and on any thread, returns once all are done
+    void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& task);
+
+private:
+    struct Job
+    {
+        const std::function<void(uint32_t)>* task;
+        uint32_t count;
+        std::atomic<uint32_t> next{0};       // next iteration to hand out
+        std::atomic<uint32_t> remaining{0};  // iterations not finished yet
+    };
+
+    void RunJob(Job& job);
+    void Work();
+
+    std::mutex mutex;
+    std::condition_variable jobCv;   // a job was queued or the pool is stopping
+    std::condition_variable doneCv;  // the last iteration of a job finished
+    std::deque<std::shared_ptr<Job> > jobs;
+    bool stopping = false;
+    std::vector<std::thread> threads;
+};
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#include "buffer_pool.h"
+#include <stdlib.h>
+
+#define BUFFER_ALIGN 64
+
+BufferPool::FreeLists::~FreeLists()
+{
+    for (auto& list : blocks) {
+        for (char* block : list.second) {
+            free(block);
+        }
+    }
+}
+
+char* BufferPool::FreeLists::Take(uint64_t blockSize)
+{
+    std::unique_lock <std::mutex> lck(mutex);
+    auto it = blocks.find(blockSize);
+    if (it == blocks.end() || it->second.empty()) {
+        return nullptr;
+    }
+    char* block = it->second.back();
+    it->second.pop_back();
+    idleBytes -= blockSize;
+    return block;
+}
+
+void BufferPool::FreeLists::Release(char* block, uint64_t blockSize)
+{
+    {
+        std::unique_lock <std::mutex> lck(mutex);
+        if (idleBytes + blockSize <= maxIdleBytes) {
+            blocks[blockSize].push_back(block);
+            idleBytes += blockSize;
+            return;
+        }
+    }
+    free(block);
+}
+
+BufferPool::BufferPool(uint64_t maxIdleBytes)
+    : freeLists(std::make_shared<FreeLists>(maxIdleBytes))
+{
+}
+
+std::shared_ptr<char> BufferPool::Acquire(uint64_t size)
+{
+    if (size == 0 || size > BUFFER_MAX_BYTES) {
+        return nullptr;
+    }
+    uint64_t blockSize = size;
+    char* block = freeLists->Take(blockSize);
+    if (block == nullptr) {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, BUFFER_ALIGN, blockSize) != 0) {
+            return nullptr;
+        }
+        block = static_cast<char*>(memory);
+    }
+    std::shared_ptr<FreeLists> lists = freeLists;
+    return std::shared_ptr<char>(block, [lists, blockSize](char* p) {
+        lists->Release(p, blockSize);
+    });
+}
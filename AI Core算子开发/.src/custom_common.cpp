@@ -7,6 +7,13 @@
 
 #include "custom_common.h"
 #include "hiaiengine/data_type_reg.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 
 template<class Archive>
@@ -14,34 +21,87 @@ void serialize(Archive& ar, CustomFileBlob& data)
 {
     ar(data.size);
     if (data.size > 0 && data.data.get() == nullptr) {
-        data.data.reset(new char[data.size]);
+        data.data.reset(new char[data.size], [](char* p) { delete[] p; });
     }
     ar(cereal::binary_data(data.data.get(), data.size * sizeof(char)));
 }
 
 
+template<class Archive>
+void serialize(Archive& ar, InputGenerator& generator)
+{
+    ar(generator.distribution, generator.elemType, generator.elemNum, generator.seed, generator.param0,
+       generator.param1);
+}
+
+template<class Archive>
+void serialize(Archive& ar, ChainStage& stage)
+{
+    ar(stage.name, stage.type, stage.binFile, stage.binFileHash, stage.outputSizeList, stage.inputLinkList,
+       stage.inputList, stage.inputSizeList, stage.workspaceSizeList);
+}
+
+template<class Archive>
+void serialize(Archive& ar, ChainTap& tap)
+{
+    ar(tap.stage, tap.output);
+}
+
 template<class Archive>
 void serialize(Archive& ar, CustomInfo& info)
 {
-    ar(info.name, info.type, info.outputSizeList, info.binFile, info.inputList,
+    auto begin = std::chrono::steady_clock::now();
+    ar(info.requestId, info.name, info.type, info.outputSizeList, info.binFile, info.inputList,
+       info.inputGeneratorList,
        info.configFile,
        info.dataTypeList,
        info.precisionDeviation,
        info.statisticalDiscrepancy,
-       info.expectFileList);
+       info.expectFileList,
+       info.returnOutputs,
+       info.chunkInput,
+       info.chunkRole,
+       info.chunkStage,
+       info.chunkOffset,
+       info.inputSizeList,
+       info.expectSizeList,
+       info.chainList,
+       info.tapList,
+       info.binFileHash,
+       info.configFileHash,
+       info.scratchBacking,
+       info.workspaceSizeList);
+    if (Archive::is_loading::value) {
+        info.deserializeTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin)
+                               .count();
+    }
+}
+
+template<class Archive>
+void serialize(Archive& ar, StageTiming& timing)
+{
+    ar(timing.deserialize, timing.inputStaging, timing.binaryStaging, timing.readback, timing.compare);
+}
+
+template<class Archive>
+void serialize(Archive& ar, CompareStats& stats)
+{
+    ar(stats.elemNum, stats.deviated, stats.maxAbsError, stats.maxRelError, stats.ulpHistogram,
+       stats.firstMismatches);
 }
 
 template<class Archive>
 void serialize(Archive& ar, CustomOutput& info)
 {
-    ar(info.size, info.outputList, info.compareResultList);
+    ar(info.requestId, info.size, info.outputList, info.compareResultList, info.opRunTime, info.kernelMissing,
+       info.compareStatsList, info.timing, info.missingKernels, info.failed);
 }
 
 HIAI_REGISTER_DATA_TYPE("CustomFileBlob", CustomFileBlob)
 HIAI_REGISTER_DATA_TYPE("CustomInfo", CustomInfo)
 HIAI_REGISTER_DATA_TYPE("CustomOutput", CustomOutput)
 
-int32_t  WriteFile(const char* fileName, const char* buffer, uint32_t size)
+int32_t  WriteFile(const char* fileName, const char* buffer, uint64_t size)
 {
     if (fileName == NULL || buffer == NULL) {
         HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Invalid writeFile param!");
@@ -60,7 +120,7 @@ int32_t  WriteFile(const char* fileName, const char* buffer, uint32_t size)
     return 0;
 }
 
-char* ReadFile(const char *fileName, uint32_t *fileSize)
+char* ReadFile(const char *fileName, uint64_t *fileSize)
 {
     if (fileName == NULL || fileSize == NULL) {
         HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Invalid readFile param!");
@@ -73,7 +133,12 @@ char* ReadFile(const char *fileName, uint32_t *fileSize)
         return NULL;
     }
     std::filebuf *pbuf = filestr.rdbuf();
-    size_t size = pbuf->pubseekoff(0, std::ios::end, std::ios::in);
+    std::streamoff end = pbuf->pubseekoff(0, std::ios::end, std::ios::in);
+    if (end < 0) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "File %s cannot seek when readFile!", fileName);
+        return NULL;
+    }
+    size_t size = end;
     pbuf->pubseekpos(0, std::ios::in);
     char * buffer = new char[size];
     if (buffer == NULL) {
@@ -88,4 +153,196 @@ char* ReadFile(const char *fileName, uint32_t *fileSize)
     return buffer;
 }
 
+static const uint64_t READ_STREAM_BLOCK = 1024 * 1024;  // first buffer of a pipe or device read
+
+// pipes and devices cannot seek, so they are read to the end into a buffer that grows as it fills
+static char* ReadStream(int fd, uint64_t *fileSize)
+{
+    uint64_t capacity = READ_STREAM_BLOCK;
+    uint64_t size = 0;
+    char* buffer = new char[capacity];
+    while (true) {
+        if (size == capacity) {
+            char* grown = new char[capacity * 2];
+            memcpy(grown, buffer, size);
+            delete[] buffer;
+            buffer = grown;
+            capacity *= 2;
+        }
+        ssize_t ret = read(fd, buffer + size, capacity - size);
+        if (ret == 0) {
+            break;
+        }
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret < 0) {
+            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Read file Failed when readStream!");
+            delete[] buffer;
+            return NULL;
+        }
+        size += ret;
+    }
+    *fileSize = size;
+    return buffer;
+}
+
+int32_t LoadFileBlob(const char *fileName, CustomFileBlob& fileBlob)
+{
+    if (fileName == NULL) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Invalid loadFileBlob param!");
+        return -1;
+    }
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Open file Failed when loadFileBlob!");
+        return -1;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Stat file Failed when loadFileBlob!");
+        close(fd);
+        return -1;
+    }
+    if (!S_ISREG(fileStat.st_mode)) {
+        uint64_t size = 0;
+        char* buffer = ReadStream(fd, &size);
+        close(fd);
+        if (buffer == NULL) {
+            return -1;
+        }
+        fileBlob.size = size;
+        fileBlob.data.reset(buffer, [](char* p) { delete[] p; });
+        return 0;
+    }
+    if (fileStat.st_size > 0) {
+        size_t size = fileStat.st_size;
+        void* addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (addr != MAP_FAILED) {
+            // borrow the mapped pages, they are released with the last blob copy
+            fileBlob.size = size;
+            fileBlob.data.reset(static_cast<char*>(addr), [size](char* p) { munmap(p, size); });
+            return 0;
+        }
+        HIAI_ENGINE_LOG(HIAI_IDE_WARNING, "Mmap file failed, fall back to readFile!");
+    } else {
+        close(fd);
+    }
+
+    // empty files, or mapping failed
+    uint64_t size = 0;
+    char* buffer = ReadFile(fileName, &size);
+    if (buffer == NULL) {
+        return -1;
+    }
+    fileBlob.size = size;
+    fileBlob.data.reset(buffer, [](char* p) { delete[] p; });
+    return 0;
+}
+
+int32_t WriteFileAt(const char* fileName, const char* buffer, uint64_t size, uint64_t offset, bool truncate)
+{
+    if (fileName == NULL || (buffer == NULL && size > 0)) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Invalid writeFileAt param!");
+        return -1;
+    }
+    int fd = open(fileName, O_WRONLY | O_CREAT | (truncate ? O_TRUNC : 0), 0644);
+    if (fd < 0) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Open file Failed when writeFileAt!");
+        return -1;
+    }
+    uint64_t written = 0;
+    while (written < size) {
+        ssize_t ret = pwrite(fd, buffer + written, size - written, offset + written);
+        if (ret <= 0) {
+            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Write file Failed when writeFileAt!");
+            close(fd);
+            return -1;
+        }
+        written += ret;
+    }
+    close(fd);
+    return 0;
+}
 
+static const uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+static const uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t Rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t Read64(const char* p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t HashRound(uint64_t acc, uint64_t input)
+{
+    acc += input * PRIME64_2;
+    return Rotl64(acc, 31) * PRIME64_1;
+}
+
+static inline uint64_t HashMerge(uint64_t acc, uint64_t val)
+{
+    acc ^= HashRound(0, val);
+    return acc * PRIME64_1 + PRIME64_4;
+}
+
+uint64_t HashBytes(const char* data, uint64_t size, uint64_t seed)
+{
+    const char* p = data;
+    const char* end = data + size;
+    uint64_t h;
+    if (size >= 32) {
+        uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+        uint64_t v2 = seed + PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME64_1;
+        const char* limit = end - 32;
+        do {
+            v1 = HashRound(v1, Read64(p));
+            v2 = HashRound(v2, Read64(p + 8));
+            v3 = HashRound(v3, Read64(p + 16));
+            v4 = HashRound(v4, Read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h = Rotl64(v1, 1) + Rotl64(v2, 7) + Rotl64(v3, 12) + Rotl64(v4, 18);
+        h = HashMerge(h, v1);
+        h = HashMerge(h, v2);
+        h = HashMerge(h, v3);
+        h = HashMerge(h, v4);
+    } else {
+        h = seed + PRIME64_5;
+    }
+    h += size;
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= HashRound(0, Read64(p));
+        h = Rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+    }
+    if (p + 4 <= end) {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        h ^= (uint64_t)v * PRIME64_1;
+        h = Rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        h ^= (uint64_t)(unsigned char)*p * PRIME64_5;
+        h = Rotl64(h, 11) * PRIME64_1;
+    }
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
@@ -0,0 +1,506 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+// Concurrency stress of the CUSTOMEngine request path. Threads push random requests through
+// one OpExecutor, as the engine threads of graph.config do, on a host stand-in runtime that
+// works on scratch files like custom::custom_op_run. Inputs come as blobs, chunks staged by
+// other threads in random order, or generators; kernels are shared through the kernel cache,
+// some requests chain a second kernel with or without a side input, compare with expect
+// tensors or ask for workspaces; side inputs and expect tensors may come as chunks too.
+// Every output is checked against the result computed here, no scratch file may be left
+// behind, and every input a run gets must be on the backing of its own request, which are
+// mixed unless one is given. Before that, CompareTensor has to flag infinities that differ
+// from the expected value on the vector and the scalar path.
+//   ./engine_stress [threads(8)] [requests per thread(200)] [mixed|disk|tmpfs|memfd]
+#include <dirent.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "input_generator.h"
+#include "op_executor.h"
+#include "tensor_compare.h"
+
+#define SUCCESS 0
+#define FAILED -1
+
+static const uint32_t KERNEL_NUM = 4;
+static const uint32_t MAX_TENSOR_BYTES = 64 * 1024;
+static const uint32_t MAX_RUN_SLEEP_US = 200;
+static const uint32_t MAX_WORKSPACE_BYTES = 256 * 1024;
+static const uint64_t REPEATED_OUTPUT_BYTES[] = {1, 4096, 5000, 65536};
+static const uint64_t LARGE_OUTPUT_BYTES = PARALLEL_READBACK_BYTES;
+
+static std::string ReadAll(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+// output j byte k = first bin byte + j + sum of input i byte k (cyclic)
+static std::string StandinOutput(char salt, const std::vector<std::string>& inputs, uint32_t j, uint64_t size)
+{
+    std::string out(size, 0);
+    for (uint64_t k = 0; k < size; k++) {
+        char value = salt + (char)j;
+        for (auto& input : inputs) {
+            value += input.empty() ? 0 : input[k % input.size()];
+        }
+        out[k] = value;
+    }
+    return out;
+}
+
+static bool OnBacking(const std::string& path, int32_t backing)
+{
+    const char* prefix = (backing == SCRATCH_MEMFD) ? "/proc/self/fd/" :
+                         (backing == SCRATCH_TMPFS) ? SCRATCH_TMPFS_DIR : SCRATCH_DISK_DIR;
+    return path.compare(0, strlen(prefix), prefix) == 0;
+}
+
+// file based stand-in of the DDK runtime, every path comes from the executor
+class StandinOpRuntime : public OpRuntime
+{
+public:
+    bool NeedsFiles() const
+    {
+        return true;
+    }
+
+    int32_t Run(const OpKernel& kernel, const std::vector<std::shared_ptr<OpBuffer> >& inputs,
+                const std::vector<std::string>& outputNames, const std::vector<uint64_t>& outputSizes,
+                std::vector<std::shared_ptr<OpBuffer> >& outputs, double& opRunTime)
+    {
+        std::chrono::steady_clock::time_point runBegin = std::chrono::steady_clock::now();
+        std::string binPath;
+        if (kernel.binFile == nullptr || kernel.binFile->File(binPath, kernel.scratchBacking) != SUCCESS) {
+            return FAILED;
+        }
+        std::string bin = ReadAll(binPath);
+        std::vector<std::string> inputData;
+        for (auto& input : inputs) {
+            std::string path;
+            if (input->File(path, kernel.scratchBacking) != SUCCESS || !OnBacking(path, kernel.scratchBacking)) {
+                return FAILED;
+            }
+            inputData.push_back(ReadAll(path));
+        }
+        // widen the window in which another request could touch the same files
+        usleep(rand() % MAX_RUN_SLEEP_US);
+        outputs.clear();
+        for (uint32_t j = 0; j < outputSizes.size(); j++) {
+            std::unique_ptr<ScratchFile> file = ScratchFile::Create(outputNames[j], kernel.scratchBacking);
+            std::string data = StandinOutput(bin.empty() ? 0 : bin[0], inputData, j, outputSizes[j]);
+            if (file == nullptr || WriteFileAt(file->Path().c_str(), data.data(), data.size(), 0, true) != SUCCESS) {
+                return FAILED;
+            }
+            outputs.push_back(OpBuffer::FromFile(std::move(file), outputSizes[j]));
+        }
+        opRunTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - runBegin).count();
+        return SUCCESS;
+    }
+};
+
+struct StressCase
+{
+    std::shared_ptr<CustomInfo> customInfo;
+    std::shared_ptr<CustomInfo> resent;  // with every kernel blob, for a kernelMissing reply
+    std::vector<std::shared_ptr<CustomInfo> > chunks;  // staged by a helper thread in random order
+    std::vector<std::string> expectOutputs;
+    std::vector<int32_t> expectCompare;
+};
+
+static CustomFileBlob MakeBlob(const std::string& data)
+{
+    std::shared_ptr<char> ptr(new char[data.size() + 1], [](char* p) {
+        delete[] p;
+    });
+    memcpy(ptr.get(), data.data(), data.size());
+    return {data.size(), ptr};
+}
+
+static std::string BlobString(const CustomFileBlob& blob)
+{
+    return (blob.data == nullptr) ? std::string() : std::string(blob.data.get(), blob.size);
+}
+
+static std::string KernelBlob(uint32_t kernel)
+{
+    std::string bin = "stand-in kernel ";
+    bin[0] = (char)(kernel + 1);
+    return bin + std::to_string(kernel);
+}
+
+// data as chunk messages of random size, staged in random order among the other chunks
+static void AddChunks(StressCase& stressCase, int32_t role, int32_t stage, uint32_t index, const std::string& data,
+                      std::mt19937& rng)
+{
+    uint64_t chunkSize = 1 + rng() % (data.size() / 4 + 1);
+    for (uint64_t offset = 0; offset < data.size(); offset += chunkSize) {
+        std::shared_ptr<CustomInfo> chunk = std::make_shared<CustomInfo>();
+        chunk->requestId = stressCase.customInfo->requestId;
+        chunk->chunkInput = index;
+        chunk->chunkRole = role;
+        chunk->chunkStage = stage;
+        chunk->chunkOffset = offset;
+        chunk->scratchBacking = stressCase.customInfo->scratchBacking;
+        chunk->inputList.push_back(MakeBlob(data.substr(offset, chunkSize)));
+        stressCase.chunks.push_back(chunk);
+    }
+    std::shuffle(stressCase.chunks.begin(), stressCase.chunks.end(), rng);
+}
+
+static StressCase MakeCase(uint32_t requestId, int32_t backing, std::mt19937& rng)
+{
+    StressCase stressCase;
+    stressCase.customInfo = std::make_shared<CustomInfo>();
+    CustomInfo& info = *stressCase.customInfo;
+    info.requestId = requestId;
+    info.name = "Standin";
+    info.scratchBacking = backing;
+    uint32_t kernel = rng() % KERNEL_NUM;
+    std::string bin = KernelBlob(kernel);
+    info.binFile = MakeBlob(bin);
+    info.binFileHash = (rng() % 4 == 0) ? 0 : HashBytes(bin.data(), bin.size(), 0);
+
+    std::vector<std::string> inputs;
+    uint32_t inputNum = 1 + rng() % 3;
+    for (uint32_t i = 0; i < inputNum; i++) {
+        uint64_t size = 1 + rng() % MAX_TENSOR_BYTES;
+        uint32_t kind = rng() % 4;
+        if (kind == 0) {
+            // expanded by the executor, values 0..31 like the blobs
+            InputGenerator generator;
+            generator.distribution = GEN_UNIFORM;
+            generator.elemType = GEN_UINT8;
+            generator.elemNum = size;
+            generator.seed = rng();
+            generator.param0 = 0;
+            generator.param1 = 31;
+            std::string data(size, 0);
+            GenerateElements(generator, 0, size, &data[0]);
+            inputs.push_back(data);
+            info.inputList.push_back({0, nullptr});
+            info.inputGeneratorList.resize(inputNum);  // GEN_NONE for the other inputs
+            info.inputGeneratorList[i] = generator;
+            info.inputSizeList.push_back(0);
+            continue;
+        }
+        std::string data(size, 0);
+        for (auto& c : data) {
+            c = (char)(rng() % 32);
+        }
+        inputs.push_back(data);
+        info.inputSizeList.push_back(size);
+        if (kind == 1) {
+            // streamed in chunks ahead of the request
+            AddChunks(stressCase, CHUNK_INPUT, 0, i, data, rng);
+            info.inputList.push_back({0, nullptr});
+            continue;
+        }
+        info.inputList.push_back(MakeBlob(data));
+    }
+
+    for (uint32_t w = (rng() % 2 == 0) ? 1 + rng() % 2 : 0; w > 0; w--) {
+        info.workspaceSizeList.push_back(1 + rng() % MAX_WORKSPACE_BYTES);
+    }
+    uint32_t outputNum = 1 + rng() % 3;
+    for (uint32_t j = 0; j < outputNum; j++) {
+        // half of the outputs repeat a few sizes, like benchmark runs, and reuse readback buffers
+        uint64_t size = (rng() % 2 == 0) ? REPEATED_OUTPUT_BYTES[rng() % 4] : 1 + rng() % MAX_TENSOR_BYTES;
+        if (rng() % 8 == 0) {
+            // large enough for the outputs of the request to be read back in parallel
+            size = LARGE_OUTPUT_BYTES;
+        }
+        info.outputSizeList.push_back(size);
+        stressCase.expectOutputs.push_back(StandinOutput(bin[0], inputs, j, size));
+    }
+    if (rng() % 4 == 0) {
+        // a second kernel on output 0, stage 0 output 0 is tapped
+        uint32_t stageKernel = rng() % KERNEL_NUM;
+        std::string stageBin = KernelBlob(stageKernel);
+        ChainStage stage;
+        stage.name = "StandinStage";
+        stage.binFile = MakeBlob(stageBin);
+        stage.binFileHash = HashBytes(stageBin.data(), stageBin.size(), 0);
+        stage.inputLinkList = {0};
+        stage.inputList = {{0, nullptr}};
+        stage.inputSizeList = {0};
+        stage.outputSizeList = {1 + rng() % MAX_TENSOR_BYTES};
+        if (rng() % 2 == 0) {
+            stage.workspaceSizeList = {1 + rng() % MAX_WORKSPACE_BYTES};
+        }
+        std::string tapped = stressCase.expectOutputs[0];
+        std::vector<std::string> stageInputs = {tapped};
+        if (rng() % 2 == 0) {
+            // a side input of the stage, like conv weights, sent whole or in chunks
+            std::string side(1 + rng() % MAX_TENSOR_BYTES, 0);
+            for (auto& c : side) {
+                c = (char)(rng() % 32);
+            }
+            stageInputs.push_back(side);
+            stage.inputLinkList.push_back(-1);
+            stage.inputSizeList.push_back(side.size());
+            if (rng() % 2 == 0) {
+                AddChunks(stressCase, CHUNK_INPUT, 1, 1, side, rng);
+                stage.inputList.push_back({0, nullptr});
+            } else {
+                stage.inputList.push_back(MakeBlob(side));
+            }
+        }
+        info.chainList.push_back(stage);
+        info.tapList.push_back({0, 0});
+        stressCase.expectOutputs = {StandinOutput(stageBin[0], stageInputs, 0, stage.outputSizeList[0]), tapped};
+    }
+    if (rng() % 2 == 0) {
+        // expect tensors, one of them sometimes wrong by a single byte
+        info.precisionDeviation = 0;
+        info.statisticalDiscrepancy = 0;
+        uint32_t compared = stressCase.expectOutputs.size() - info.tapList.size();
+        for (uint32_t j = 0; j < compared; j++) {
+            std::string expect = stressCase.expectOutputs[j];
+            bool corrupt = (rng() % 8 == 0);
+            if (corrupt) {
+                expect[rng() % expect.size()] ^= 0x40;
+            }
+            info.expectSizeList.push_back(expect.size());
+            info.dataTypeList.push_back(COMPARE_INT8);
+            stressCase.expectCompare.push_back(corrupt ? 0 : 1);
+            if (rng() % 2 == 0) {
+                info.expectFileList.push_back(MakeBlob(expect));
+                continue;
+            }
+            // streamed in chunks like a large input
+            AddChunks(stressCase, CHUNK_EXPECT, 0, j, expect, rng);
+            info.expectFileList.push_back({0, nullptr});
+        }
+    }
+    // hash-only kernels that are not cached yet come back as kernelMissing
+    stressCase.resent = std::make_shared<CustomInfo>(info);
+    if (info.binFileHash != 0 && rng() % 2 == 0) {
+        info.binFile = {0, nullptr};
+    }
+    for (auto& stage : info.chainList) {
+        if (rng() % 2 == 0) {
+            stage.binFile = {0, nullptr};
+        }
+    }
+    return stressCase;
+}
+
+static bool CheckOutput(const StressCase& stressCase, const CustomOutput& customOutput)
+{
+    const CustomInfo& info = *stressCase.customInfo;
+    if (customOutput.requestId != info.requestId || customOutput.kernelMissing ||
+        customOutput.outputList.size() != stressCase.expectOutputs.size() ||
+        customOutput.compareResultList != stressCase.expectCompare ||
+        customOutput.compareStatsList.size() != stressCase.expectCompare.size()) {
+        return false;
+    }
+    for (uint32_t j = 0; j < stressCase.expectCompare.size(); j++) {
+        if (customOutput.compareStatsList[j].deviated != (stressCase.expectCompare[j] ? 0U : 1U)) {
+            return false;
+        }
+    }
+    for (uint32_t j = 0; j < stressCase.expectOutputs.size(); j++) {
+        if (BlobString(customOutput.outputList[j]) != stressCase.expectOutputs[j]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the request with its chunks staged concurrently by another thread, as engine threads would
+static int32_t ExecuteWithChunks(OpExecutor& executor, const StressCase& stressCase, const CustomInfo& request,
+                                 CustomOutput& customOutput)
+{
+    std::atomic<bool> staged(true);
+    std::thread stager([&executor, &stressCase, &staged] {
+        for (auto& chunk : stressCase.chunks) {
+            if (executor.StageInputChunk(*chunk) != SUCCESS) {
+                staged = false;
+            }
+        }
+    });
+    int32_t ret = executor.Execute(request, customOutput);
+    stager.join();
+    return (ret == SUCCESS && staged) ? SUCCESS : FAILED;
+}
+
+// a kernelMissing reply names only kernels the request sent as hash
+static bool MissingKernelsSentAsHash(const CustomInfo& info, const std::vector<uint64_t>& missingKernels)
+{
+    std::set<uint64_t> hashOnly;
+    if (info.binFile.data == nullptr) {
+        hashOnly.insert(info.binFileHash);
+    }
+    if (info.configFile.data == nullptr) {
+        hashOnly.insert(info.configFileHash);
+    }
+    for (auto& stage : info.chainList) {
+        if (stage.binFile.data == nullptr) {
+            hashOnly.insert(stage.binFileHash);
+        }
+    }
+    for (auto hash : missingKernels) {
+        if (hashOnly.count(hash) == 0) {
+            return false;
+        }
+    }
+    return !missingKernels.empty();
+}
+
+static int32_t RunCase(OpExecutor& executor, const StressCase& stressCase, CustomOutput& customOutput)
+{
+    if (ExecuteWithChunks(executor, stressCase, *stressCase.customInfo, customOutput) != SUCCESS) {
+        return FAILED;
+    }
+    if (customOutput.kernelMissing) {
+        if (!MissingKernelsSentAsHash(*stressCase.customInfo, customOutput.missingKernels)) {
+            return FAILED;
+        }
+        // like the host: resend once with every kernel blob
+        customOutput = CustomOutput();
+        return ExecuteWithChunks(executor, stressCase, *stressCase.resent, customOutput);
+    }
+    return SUCCESS;
+}
+
+// one expect / output pair of the infinity check, as float and as fp16 bits
+struct InfinityPair
+{
+    float expect;
+    float output;
+    uint16_t expectHalf;
+    uint16_t outputHalf;
+    bool deviates;
+};
+
+static const InfinityPair INFINITY_PAIRS[] = {
+    {INFINITY, INFINITY, 0x7c00, 0x7c00, false},
+    {INFINITY, 1.0f, 0x7c00, 0x3c00, true},
+    {INFINITY, -INFINITY, 0x7c00, 0xfc00, true},
+    {2.0f, INFINITY, 0x4000, 0x7c00, true},
+    {-INFINITY, -INFINITY, 0xfc00, 0xfc00, false},
+    {2.0f, 2.0f, 0x4000, 0x4000, false},
+    {-INFINITY, 2.0f, 0xfc00, 0x4000, true},
+};
+
+// whole vector blocks and a tail of infinities against numbers and the other infinity, any
+// tolerance: each differing pair deviates and lands in the last ULP bucket
+static bool InfinitiesDeviate()
+{
+    const uint32_t elemNum = 19;
+    const uint32_t pairNum = sizeof(INFINITY_PAIRS) / sizeof(INFINITY_PAIRS[0]);
+    const int32_t dataTypes[] = {COMPARE_FP32, COMPARE_FP16};
+    const float deviations[] = {0.0f, 0.5f};
+    for (auto dataType : dataTypes) {
+        std::string expect;
+        std::string output;
+        uint64_t deviated = 0;
+        for (uint32_t i = 0; i < elemNum; i++) {
+            const InfinityPair& pair = INFINITY_PAIRS[i % pairNum];
+            if (dataType == COMPARE_FP32) {
+                expect.append(reinterpret_cast<const char*>(&pair.expect), sizeof(float));
+                output.append(reinterpret_cast<const char*>(&pair.output), sizeof(float));
+            } else {
+                expect.append(reinterpret_cast<const char*>(&pair.expectHalf), sizeof(uint16_t));
+                output.append(reinterpret_cast<const char*>(&pair.outputHalf), sizeof(uint16_t));
+            }
+            deviated += pair.deviates ? 1 : 0;
+        }
+        for (auto deviation : deviations) {
+            bool compareRet = true;
+            CompareStats stats;
+            if (CompareTensor(MakeBlob(expect), MakeBlob(output), dataType, deviation, 0, compareRet,
+                              stats) != SUCCESS || compareRet || stats.deviated != deviated ||
+                stats.ulpHistogram[COMPARE_ULP_BUCKETS - 1] != deviated) {
+                fprintf(stdout, "[Error] Compare of data type %d with deviation %g: %s.\n", dataType, deviation,
+                        CompareStatsText(stats).c_str());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static uint32_t LeftoverFiles(const char* dirName)
+{
+    char prefix[32];
+    snprintf(prefix, sizeof(prefix), "op%d_", (int)getpid());
+    uint32_t count = 0;
+    DIR* dir = opendir(dirName);
+    if (dir == NULL) {
+        return 0;
+    }
+    struct dirent* entry = NULL;
+    while ((entry = readdir(dir)) != NULL) {
+        count += (strncmp(entry->d_name, prefix, strlen(prefix)) == 0) ? 1 : 0;
+    }
+    closedir(dir);
+    return count;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t threadNum = (argc > 1) ? strtoul(argv[1], NULL, 10) : 8;
+    uint32_t requestNum = (argc > 2) ? strtoul(argv[2], NULL, 10) : 200;
+    bool mixed = (argc <= 3) || (strcmp(argv[3], "mixed") == 0);
+    int32_t backing = mixed ? SCRATCH_DISK : ParseScratchBacking(argv[3]);
+    if (argc > 4 || threadNum == 0 || backing < 0) {
+        fprintf(stderr, "Usage: %s [threads(8)] [requests per thread(200)] [mixed|disk|tmpfs|memfd]\n", argv[0]);
+        return FAILED;
+    }
+    if (!InfinitiesDeviate()) {
+        return FAILED;
+    }
+    OpExecutor executor(std::make_shared<StandinOpRuntime>());
+    std::atomic<uint32_t> failed(0);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < threadNum; t++) {
+        threads.push_back(std::thread([&executor, &failed, t, requestNum, mixed, backing] {
+            std::mt19937 rng(t + 1);
+            for (uint32_t i = 0; i < requestNum; i++) {
+                uint32_t requestId = t * requestNum + i + 1;
+                // concurrent requests on different backings must never swap files
+                int32_t requestBacking = mixed ? (int32_t)(rng() % (SCRATCH_MEMFD + 1)) : backing;
+                StressCase stressCase = MakeCase(requestId, requestBacking, rng);
+                CustomOutput customOutput;
+                if (RunCase(executor, stressCase, customOutput) != SUCCESS ||
+                    !CheckOutput(stressCase, customOutput)) {
+                    fprintf(stdout, "[Error] Request %u of thread %u is wrong.\n", requestId, t);
+                    failed++;
+                }
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    uint32_t total = threadNum * requestNum;
+    // cached kernels stay staged, one file per kernel on the backing of the request that staged
+    // it first (none on memfd); anything more is a leaked input, output or second copy of a kernel
+    uint32_t leftover = LeftoverFiles(SCRATCH_DISK_DIR) + LeftoverFiles(SCRATCH_TMPFS_DIR);
+    fprintf(stdout, "%u threads, %u requests on %s scratch files: %u wrong, %.1f requests/s, %u files left\n",
+            threadNum, total, mixed ? "mixed" : ScratchBackingName(backing), failed.load(), total / seconds, leftover);
+    return (failed == 0 && leftover <= KERNEL_NUM) ? SUCCESS : FAILED;
+}
@@ -0,0 +1,107 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#include "op_runtime.h"
+#include <chrono>
+#include "custom/custom_op.h"
+#include "../common/op_attr.h"
+
+#define CUSTOM_SUCCESS 0
+#define CUSTOM_FAILED -1
+#define RT_DEV_BINARY_MAGIC_ELF_AICPU_OPERATOR 2
+
+int32_t FileOpRuntime::Run(const OpKernel& kernel, const std::vector<std::shared_ptr<OpBuffer> >& inputs,
+                           const std::vector<std::string>& outputNames, const std::vector<uint64_t>& outputSizes,
+                           std::vector<std::shared_ptr<OpBuffer> >& outputs, double& opRunTime)
+{
+    HIAI_ENGINE_LOG(HIAI_IDE_INFO, "Custom operator run start!");
+    HIAI_ENGINE_LOG(HIAI_IDE_INFO, "Run params,name:%s, type:%d, input size=%d.", kernel.name.c_str(),
+                    kernel.type, inputs.size());
+    vector< string > inFileNames;
+    for (auto& input : inputs) {
+        string inFileName;
+        if (input->File(inFileName, kernel.scratchBacking) != CUSTOM_SUCCESS) {
+            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Stage input file %s failed.", inFileName.c_str());
+            return CUSTOM_FAILED;
+        }
+        inFileNames.push_back(inFileName);
+    }
+    vector< uint32_t > outBufSizes;
+    vector< string > outFileNames;
+    vector< std::unique_ptr<ScratchFile> > outFiles;
+    outputs.clear();
+    for (uint32_t j = 0; j < outputSizes.size() && j < outputNames.size(); j++) {
+        if (outputSizes[j] > UINT32_MAX) {
+            // custom::custom_op_run takes 32-bit buffer sizes
+            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Output %d size %llu exceeds the op run limit.", j,
+                            (unsigned long long)outputSizes[j]);
+            return CUSTOM_FAILED;
+        }
+        std::unique_ptr<ScratchFile> outFile = ScratchFile::Create(outputNames[j], kernel.scratchBacking);
+        if (outFile == nullptr) {
+            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to create %s scratch file %s.",
+                            ScratchBackingName(kernel.scratchBacking), outputNames[j].c_str());
+            return CUSTOM_FAILED;
+        }
+        outBufSizes.push_back(outputSizes[j]);
+        outFileNames.push_back(outFile->Path());
+        outFiles.push_back(std::move(outFile));
+    }
+    // the DDK allocates the workspaces of custom::custom_op_run itself, it only takes their sizes
+    vector< uint32_t > workspaceSizes;
+    for (auto size : kernel.workspaceSizes) {
+        if (size > UINT32_MAX) {
+            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Workspace size %llu exceeds the op run limit.", (unsigned long long)size);
+            return CUSTOM_FAILED;
+        }
+        workspaceSizes.push_back(size);
+    }
+
+    string binFileName;
+    if (kernel.binFile == nullptr || kernel.binFile->File(binFileName, kernel.scratchBacking) != CUSTOM_SUCCESS) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Stage bin file of %s failed.", kernel.name.c_str());
+        return CUSTOM_FAILED;
+    }
+    custom::ErrorInfo result;
+    if (kernel.type == RT_DEV_BINARY_MAGIC_ELF_AICPU_OPERATOR) {
+        OpAttr opAttr;
+        setOpParam(&opAttr);
+        string configFileName;
+        if (kernel.configFile == nullptr ||
+            kernel.configFile->File(configFileName, kernel.scratchBacking) != CUSTOM_SUCCESS) {
+            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Stage config file of %s failed.", kernel.name.c_str());
+            return CUSTOM_FAILED;
+        }
+        std::chrono::steady_clock::time_point runBegin = std::chrono::steady_clock::now();
+        result = custom::custom_op_run(kernel.name, kernel.type, binFileName, inFileNames, outFileNames, outBufSizes,
+                                       workspaceSizes, configFileName, &opAttr, sizeof(OpAttr));
+        opRunTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - runBegin).count();
+    } else {
+        std::chrono::steady_clock::time_point runBegin = std::chrono::steady_clock::now();
+        result = custom::custom_op_run(kernel.name, kernel.type, binFileName, inFileNames, outFileNames, outBufSizes,
+                                       workspaceSizes);
+        opRunTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - runBegin).count();
+    }
+
+    HIAI_ENGINE_LOG(HIAI_IDE_INFO, "Custom operator run end!");
+    if (result.error_code != 0) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Engine run failed, error_code: %d, message: %s.", result.error_code,
+                        result.error_msg.c_str());
+        return CUSTOM_FAILED;
+    }
+    for (uint32_t j = 0; j < outFiles.size(); j++) {
+        outputs.push_back(OpBuffer::FromFile(std::move(outFiles[j]), outputSizes[j]));
+    }
+    HIAI_ENGINE_LOG(HIAI_IDE_INFO, "Engine run success.");
+    return CUSTOM_SUCCESS;
+}
+
+std::shared_ptr<OpRuntime> CreateOpRuntime()
+{
+    return std::make_shared<FileOpRuntime>();
+}
@@ -4,21 +4,28 @@
 * Create: 2017-06-06
 */
 #include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <atomic>
+#include <list>
 #include <thread>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
+#include <sstream>
 #include <algorithm>
 #include <hiaiengine/graph.h>
 #include "hiaiengine/api.h"
 #include "error_code.h"
 
 #include "custom_common.h"
+#include "op_dispatcher.h"
+#include "op_sweep.h"
+#include "scratch_file.h"
+#include "test_spec.h"
 static const std::string graph_config_proto_file = "./graph.config";
-static const uint32_t GRAPH_ID = 100;
-static const uint32_t SRC_ENGINE_ID = 1000;
-static const uint32_t SRC_PORT_ID = 0;
-static const uint32_t DST_ENGINE_ID = 1002;
-static const uint32_t DEST_PORT_ID = 0;
-static const int MAX_SLEEP_TIMER = 30 * 60;
 
 #define RT_DEV_BINARY_MAGIC_ELF 0
 #define RT_DEV_BINARY_MAGIC_ELF_AICPU 1
@@ -34,175 +41,61 @@ namespace config
     // op run related
     static std::string name = "";
     static int32_t     type = RT_DEV_BINARY_MAGIC_ELF_AICPU_OPERATOR;  // 0: ai core ; 1: ai cpu
-    static std::vector< uint32_t >    outputSizeList = {};
+    static std::vector< uint64_t >    outputSizeList = {};
     static const std::string                configFile      = "./custom_op.cfg";
     static std::string                binFile         = "";
     static std::vector< std::string > inputFileList  = {};
+    static std::vector< InputGenerator > inputGeneratorList = {};  // empty, or one per input file
     static std::vector< std::string > outputFileList  = {};
-    static std::vector<int32_t>                  dataTypeList            = {};  // FP32（0）、FP16（1）
+    static std::vector< uint64_t >    workspaceSizeList = {};
+    static std::vector<int32_t>                  dataTypeList            = {};  // CompareDataType: FP32（0）、FP16（1）、INT8（2）、INT32（3）、BF16（4）
     // compare related
     static float                      precisionDeviation     = 0.8;
     static float                      statisticalDiscrepancy = 0.8;
     static std::vector< std::string > expectFileList        = {};
+    static bool                       hostCompare           = false;  // compare on the host, expects stay here
+    static int32_t                    returnOutputs         = RETURN_OUTPUTS_ALWAYS;
+    // values from the command line, every manifest line or daemon job starts from them
+    static bool                       baseHostCompare       = false;
+    static int32_t                    baseReturnOutputs     = RETURN_OUTPUTS_ALWAYS;
+    static int32_t                    scratchBacking        = SCRATCH_DISK;  // where the device stages files
+    static int32_t                    baseScratchBacking    = SCRATCH_DISK;
+    // chain related, kernels run on the device after the one above, see TestSpec::chain
+    struct ChainStageConfig
+    {
+        std::string name;
+        int32_t type;
+        std::string binFile;
+        std::vector< uint64_t > outputSizeList;
+        std::vector< int32_t > inputLinkList;
+        std::vector< std::string > inputFileList;  // empty for linked inputs
+        std::vector< uint64_t > workspaceSizeList;
+    };
+    static std::vector< ChainStageConfig > chainList     = {};
+    static std::vector< ChainTap >    tapList               = {};
+    static std::vector< std::string > tapFileList           = {};  // written after the final outputs
+    // batch related
+    static std::string                manifestFile           = "";
+    static std::string                daemonSocket           = "";  // serve jobs on this unix socket
+    // sweep related
+    static std::string                sweepFile              = "";
+    static bool                       hostRuntime            = false;  // time the host stand-in, no device needed
+    // benchmark related
+    static uint32_t                   warmup                 = 0;
+    static uint32_t                   iterations             = 0;
+    // inputs larger than this are streamed to CUSTOMEngine in chunks
+    static uint64_t                   chunkSize              = 256ULL * 1024 * 1024;
+    // dispatch related
+    static uint32_t                   replicas               = 1;
+    static uint32_t                   inflight               = 1;  // requests queued per replica
+    static DispatchPolicy             dispatchPolicy         = DISPATCH_ROUND_ROBIN;
+    // result cache related
+    static CacheMode                  cacheMode              = CACHE_USE;
+    static std::string                cacheDir               = "./op_run_cache";
 }  // namespace config
 
 
 #define BASE_NAME std::string("custom_op_run_temp_file_")
-static std::mutex localTestMutex;
-static std::condition_variable localTestCv;
-static bool isTestResultReady = false;
-
-// Define Data Recv Interface
-class DdkDataRecvInterface : public hiai::DataRecvInterface
-{
-public:
-    DdkDataRecvInterface()
-    {
-    }
-    ~DdkDataRecvInterface()
-    {
-    }
-
-    /**
-    * @ingroup hiaiengine
-    * @brief
-    * @param [in]
-    * @return HIAI Status
-    */
-    HIAI_StatusT RecvData(const std::shared_ptr<void>& message)
-    {
-        HIAI_ENGINE_LOG(HIAI_IDE_INFO, "Receive data.");
-
-        std::shared_ptr<CustomOutput> customOutput =
-            std::static_pointer_cast<CustomOutput>(message);
-        if (customOutput == nullptr) {
-            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Fail to receive data");
-            std::unique_lock <std::mutex> lck(localTestMutex);
-            isTestResultReady = true;
-            return HIAI_INVALID_INPUT_MSG;
-        }
-        if (config::outputFileList.size() != customOutput->outputList.size()) {
-            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Config output file list: %d != customOutput size: %d",
-                            config::outputFileList.size(), customOutput->outputList.size());
-            std::unique_lock <std::mutex> lck(localTestMutex);
-            isTestResultReady = true;
-            return HIAI_INVALID_INPUT_MSG;
-        }
-
-        for (uint32_t i = 0; i < customOutput->outputList.size(); i++) {
-            WriteFile(config::outputFileList[i].c_str(), customOutput->outputList[i].data.get(),
-                      customOutput->outputList[i].size);
-            HIAI_ENGINE_LOG(HIAI_IDE_INFO, "Write output file %d success! s%", i, config::outputFileList[i].c_str());
-        }
-
-        std::string vertifyResultFileName = "./output/vertifyResult.txt";
-        std::ofstream tfile(vertifyResultFileName);
-        if (tfile.is_open()) {
-            uint32_t ind_file = 0;
-            for (auto compareResult : customOutput->compareResultList) {
-                if (ind_file < config::outputFileList.size()) {
-                    tfile << "Output file " << config::outputFileList[ind_file] << " compare result ";
-                    tfile << (compareResult ? "true" : "false") << std::endl;
-                    ind_file++;
-                } else {
-                    HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "ind_file is %d, outputFileList size is %d!", ind_file,
-                                    config::outputFileList.size());
-                    tfile.close();
-                    std::unique_lock <std::mutex> lck(localTestMutex);
-                    isTestResultReady = true;
-                    return HIAI_ERROR;
-                }
-            }
-            if (0 == customOutput->compareResultList.size()) {
-                tfile << "None vertification result!" << std::endl;
-                tfile << "If you prefer to vertify output(s), please set vertify configuration." << std::endl;
-            }
-            tfile.close();
-        } else {
-            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to open vertifResult file %s!", vertifyResultFileName.c_str());
-            std::unique_lock <std::mutex> lck(localTestMutex);
-            isTestResultReady = true;
-            return HIAI_ERROR;
-        }
-
-        std::unique_lock <std::mutex> lck(localTestMutex);
-        isTestResultReady = true;
-
-        HIAI_ENGINE_LOG(HIAI_IDE_INFO, "Receive data ok.");
-        return HIAI_OK;
-    }
-private:
-
-    std::string fileName;
-};
-
-
-// if device is disconnected, destroy the graph
-HIAI_StatusT DeviceDisconnectCallBack()
-{
-    localTestMutex.lock();
-    isTestResultReady = true;
-    localTestMutex.unlock();
-    return HIAI_OK;
-}
-
-// Init and create graph
-HIAI_StatusT HIAI_InitAndStartGraph()
-{
-    // Step1: Global System Initialization before using HIAI Engine
-    HIAI_StatusT status = HIAI_Init(0);
-
-    // Step2: Create and Start the Graph
-    status = hiai::Graph::CreateGraph(graph_config_proto_file);
-    if (status != HIAI_OK) {
-        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to start graph.");
-        return status;
-    }
-
-    // Step3: create graph
-    std::shared_ptr<hiai::Graph> graph = hiai::Graph::GetInstance(GRAPH_ID);
-    if (nullptr == graph) {
-        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to get the graph-%u.", GRAPH_ID);
-        return status;
-    }
-
-    hiai::EnginePortID target_port_config{.graph_id = GRAPH_ID, .engine_id = DST_ENGINE_ID, .port_id = DEST_PORT_ID};
-
-    DdkDataRecvInterface *ddkRecv = nullptr;
-    try {
-        ddkRecv = new DdkDataRecvInterface();
-    } catch (const std::bad_alloc& e) {
-        return HIAI_ERROR;
-    }
-    graph->SetDataRecvFunctor(target_port_config,
-        std::shared_ptr<DdkDataRecvInterface>(ddkRecv));
-    if ((config::type==RT_DEV_BINARY_MAGIC_ELF)||(config::type==RT_DEV_BINARY_MAGIC_ELF_AICPU)){
-	    graph->RegisterEventHandle(hiai::HIAI_DEVICE_DISCONNECT_EVENT,
-            DeviceDisconnectCallBack);
-	}
-    return HIAI_OK;
-}
-
-
-void checkDestFileExist()
-{
-    int i = 0;
-    while (true) {
-        i++;
-        HIAI_ENGINE_LOG(HIAI_IDE_WARNING, "Check result, go into sleep 10s.");
-        sleep(10);
-        std::unique_lock <std::mutex> lck(localTestMutex);
-        if (isTestResultReady) {
-            localTestCv.notify_all();
-            break;
-        }
-        if (i > 30) {
-            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Get output file failed. ");
-            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Please stop and check input and output data.");
-        }
-    }
-}
-
 int ReadInputFile(std::string path, FILE *stream)
 {
     std::string inputData = "";
@@ -274,10 +167,15 @@ int GetSizeData(std::string inputData, FILE *stream)
             return FAILED;
         }
     }
-    uint32_t intSize = 0;
-    intSize = stoi(inputSize);
+    const unsigned int MAX_SIZE_DIGITS = 19;
+    if (inputSize.length() > MAX_SIZE_DIGITS) {
+        fprintf(stream, "[Error] Illegal input.\n");
+        return FAILED;
+    }
+    uint64_t intSize = 0;
+    intSize = stoull(inputSize);
     config::outputSizeList.push_back(intSize);
-    fprintf(stream, "output size :%d\n", intSize);
+    fprintf(stream, "output size :%llu\n", (unsigned long long)intSize);
     return SUCCESS;
 }
 
@@ -323,7 +221,7 @@ int GetDtype(std::string inputData, FILE *stream)
     }
     int32_t intType = 0;
     intType = stoi(inputType);
-    if ((intType != 0) && (intType != 1)) {
+    if ((intType < COMPARE_FP32) || (intType > COMPARE_BF16)) {
         fprintf(stream, "[Error] Illegal input.\n");
         return FAILED;
     }
@@ -544,6 +442,19 @@ void UpgradeCmdUsage(FILE *stream)
             "\t./op_run -i input1,input2 -o output1,output2 -e expect1,expect2 -b aicpu.so -k Reduction -t 0\n"
             "\t./op_run --inputTensor input1,input2 --outputTensor output1,output2 --expectTensor expect1,expect2 --binFile aicpu.so --precisionDeviation 0.8 --statisticalDiscrepancy 0.8 --kernalName Reduction --type 0\n"
             "\t./op_run -i input1,input2 -o output1,output2 -e expect1,expect2 -b aicpu.so -p 0.8 -d 0.8 -k Reduction -t 0\n"
+            "\t./op_run --manifest cases.txt\n"
+            "\t./op_run --manifest cases.txt --replicas 4 --dispatch least\n"
+            "\t./op_run --manifest cases.txt --inflight 4\n"
+            "\t./op_run --spec reduction.json\n"
+            "\t./op_run -i input1 -o output1 -b Reduction.o -k Reduction -t 0 --warmup 10 --iterations 100\n"
+            "\t./op_run --spec reduction.json --cache refresh --cacheDir ./op_run_cache\n"
+            "\t./op_run --spec reduction.json --compare host\n"
+            "\t./op_run --spec reduction.json --returnOutputs on-fail\n"
+            "\t./op_run --daemon /tmp/op_run.sock --replicas 2\n"
+            "\t./op_run --connect /tmp/op_run.sock --spec reduction.json\n"
+            "\t./op_run --sweep reduction_sweep.json\n"
+            "\t./op_run --sweep reduction_sweep.json --runtime host\n"
+            "\t./op_run --spec reduction.json --scratch memfd\n"
 
             "Options:\n"
             "  --inputTensor       \n"
@@ -561,7 +472,46 @@ void UpgradeCmdUsage(FILE *stream)
             "  --kernalName     \n"
             "  -k                   Kernal name, which first letter should be capital, TE operators can be customized, C++ operators will be the same as the operator type.\n"
             "  --type     \n"
-            "  -t                   Operator type: 0 for TE operators, 1 for TE aicpu operators, 2 for C++ operators.\n");
+            "  -t                   Operator type: 0 for TE operators, 1 for TE aicpu operators, 2 for C++ operators.\n"
+            "  --manifest     \n"
+            "  -m                   Case list, one case per line with the options above, all cases run on one graph.\n"
+            "                       Quote values with blanks in '' or \"\". Options of the whole run, such as --replicas,\n"
+            "                       --inflight, --chunkSize, --dispatch, --cache and --cacheDir, go on the command line.\n"
+            "  --spec     \n"
+            "  -s                   JSON case spec with kernel, tensor shapes, dtypes, layouts, files, tolerances and workspaces.\n"
+            "  --warmup     \n"
+            "  -w                   Benchmark runs discarded before measuring, default(0).\n"
+            "  --iterations     \n"
+            "  -n                   Benchmark runs measured, 0 for a single checked run, default(0).\n"
+            "  --chunkSize     \n"
+            "  -c                   Inputs, chain inputs and expects over this many MiB go in chunks, default(256).\n"
+            "  --replicas     \n"
+            "  -r                   Number of CUSTOMEngine graph replicas cases are spread over, 1 to 64, default(1).\n"
+            "  --dispatch     \n"
+            "  -a                   Replica choice: rr for round-robin, least for least-loaded, default(rr).\n"
+            "  --inflight     \n"
+            "  -f                   Requests in flight per replica, the next cases are loaded meanwhile, 1 to 256, default(1).\n"
+            "                       Up to thread_num of CUSTOMEngine in graph.config of them run at the same time.\n"
+            "  --cache     \n"
+            "  -u                   Result cache: use, bypass, or refresh to rerun and overwrite stored results, default(use).\n"
+            "  --cacheDir     \n"
+            "  -g                   Result cache directory, default(./op_run_cache).\n"
+            "  --compare     \n"
+            "  -q                   Where outputs are compared with expect files: device, or host to send only inputs down, default(device).\n"
+            "  --returnOutputs     \n"
+            "  -y                   Outputs returned and written: always, on-fail for failed compares only, or never, default(always).\n"
+            "  --daemon     \n"
+            "  -z                   Keep the graph alive and run jobs sent to this unix socket, one job per line with the options above.\n"
+            "  --connect     \n"
+            "  -x                   Send the other options as one job to the daemon on this socket and print its result,\n"
+            "                       paths are resolved in the working directory of the daemon.\n"
+            "  --sweep     \n"
+            "  -v                   JSON sweep spec, runs one kernel over a grid of shapes and writes a CSV/JSON roofline report.\n"
+            "  --runtime     \n"
+            "  -j                   Where the sweep runs: device, or host for the CPU stand-in without a device, default(device).\n"
+            "  --scratch     \n"
+            "  -l                   Backing of the device scratch files: disk for /tmp, tmpfs for " SCRATCH_TMPFS_DIR ",\n"
+            "                       or memfd for anonymous memory, default(disk).\n");
 }
 
 int ReadFile(std::string param, char* argv, FILE *stream)
@@ -601,6 +551,297 @@ int ReadParameter(std::string param, char* argv, FILE *stream)
 }
 
 
+bool IsNumber(std::string inputString)
+{
+    if (inputString.empty() || inputString.length() > 9) {
+        return false;
+    }
+    for (unsigned int i = 0; i < inputString.length(); i++) {
+        if ((inputString[i] < '0') || (inputString[i] > '9')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int WarmupInit(std::string warmupString, FILE *stream)
+{
+    if (!IsNumber(warmupString)) {
+        fprintf(stream, "[Error] Sorry, your input is illegal, please try again.\n"
+                "Options:\n"
+                "  --warmup     \n"
+                "  -w                   Benchmark runs discarded before measuring, default(0).\n");
+        return FAILED;
+    }
+    config::warmup = stoi(warmupString);
+    fprintf(stream, "Warmup :%u\n", config::warmup);
+    return SUCCESS;
+}
+
+int IterationsInit(std::string iterationsString, FILE *stream)
+{
+    if (!IsNumber(iterationsString)) {
+        fprintf(stream, "[Error] Sorry, your input is illegal, please try again.\n"
+                "Options:\n"
+                "  --iterations     \n"
+                "  -n                   Benchmark runs measured, 0 for a single checked run, default(0).\n");
+        return FAILED;
+    }
+    config::iterations = stoi(iterationsString);
+    fprintf(stream, "Iterations :%u\n", config::iterations);
+    return SUCCESS;
+}
+
+int ChunkSizeInit(std::string chunkString, FILE *stream)
+{
+    if (!IsNumber(chunkString) || stoi(chunkString) == 0) {
+        fprintf(stream, "[Error] Sorry, your input is illegal, please try again.\n"
+                "Options:\n"
+                "  --chunkSize     \n"
+                "  -c                   Inputs, chain inputs and expects over this many MiB go in chunks, default(256).\n");
+        return FAILED;
+    }
+    config::chunkSize = stoull(chunkString) * 1024 * 1024;
+    fprintf(stream, "ChunkSize :%s MiB\n", chunkString.c_str());
+    return SUCCESS;
+}
+
+// take the whole case from one JSON spec instead of per tensor descriptor files
+int SpecInit(std::string specString, FILE *stream)
+{
+    TestSpec spec;
+    if (LoadTestSpec(specString, spec, stream) != SUCCESS) {
+        return FAILED;
+    }
+    config::name = spec.kernelName;
+    config::type = spec.type;
+    config::binFile = spec.binFile;
+    config::precisionDeviation = spec.precisionDeviation;
+    config::statisticalDiscrepancy = spec.statisticalDiscrepancy;
+    config::workspaceSizeList = spec.workspaces;
+    for (auto& input : spec.inputs) {
+        config::inputFileList.push_back(input.path);
+        config::inputGeneratorList.push_back(input.generator);
+        if (input.generator.distribution == GEN_NONE || input.path.empty()) {
+            continue;
+        }
+        // the host copy of the device stream, for computing golden data
+        if (WriteGeneratedInput(input.path.c_str(), input.generator) != SUCCESS) {
+            fprintf(stream, "[Error] Write generated input %s failed.\n", input.path.c_str());
+            return FAILED;
+        }
+        fprintf(stream, "Generated input :%s, seed %llu\n", input.path.c_str(),
+                (unsigned long long)input.generator.seed);
+    }
+    for (uint32_t i = 0; i < spec.outputs.size(); i++) {
+        config::outputSizeList.push_back(spec.outputs[i].size);
+        if (!spec.chain.empty() && !spec.outputs[i].path.empty()) {
+            config::tapList.push_back({0, (int32_t)i});
+            config::tapFileList.push_back(spec.outputs[i].path);
+        }
+    }
+    for (uint32_t s = 0; s < spec.chain.size(); s++) {
+        const StageSpec& stage = spec.chain[s];
+        config::ChainStageConfig stageConfig = {stage.kernelName, stage.type, stage.binFile, {}, {}, {},
+                                                stage.workspaces};
+        for (auto& input : stage.inputs) {
+            stageConfig.inputLinkList.push_back(input.from);
+            stageConfig.inputFileList.push_back(input.from < 0 ? input.path : "");
+        }
+        for (uint32_t i = 0; i < stage.outputs.size(); i++) {
+            stageConfig.outputSizeList.push_back(stage.outputs[i].size);
+            if (s + 1 < spec.chain.size() && !stage.outputs[i].path.empty()) {
+                config::tapList.push_back({(int32_t)s + 1, (int32_t)i});
+                config::tapFileList.push_back(stage.outputs[i].path);
+            }
+        }
+        config::chainList.push_back(stageConfig);
+    }
+    const std::vector<TensorSpec>& finalOutputs = spec.chain.empty() ? spec.outputs : spec.chain.back().outputs;
+    for (auto& output : finalOutputs) {
+        config::outputFileList.push_back(output.path);
+        config::dataTypeList.push_back(output.dataType);
+        if (!output.expect.empty()) {
+            config::expectFileList.push_back(output.expect);
+        }
+    }
+    if (!config::expectFileList.empty() && config::expectFileList.size() != finalOutputs.size()) {
+        fprintf(stream, "[Error] Spec should give \"expect\" for all outputs or none.\n");
+        return FAILED;
+    }
+    fprintf(stream, "Spec :%s, %zu inputs, %zu outputs, %zu chained kernels\n", specString.c_str(),
+            spec.inputs.size(), finalOutputs.size(), spec.chain.size());
+    return SUCCESS;
+}
+
+int ReplicasInit(std::string replicasString, FILE *stream)
+{
+    const int MAX_REPLICAS = 64;
+    if (!IsNumber(replicasString) || stoi(replicasString) == 0 || stoi(replicasString) > MAX_REPLICAS) {
+        fprintf(stream, "[Error] Sorry, your input is illegal, please try again.\n"
+                "Options:\n"
+                "  --replicas     \n"
+                "  -r                   Number of CUSTOMEngine graph replicas cases are spread over, 1 to 64, default(1).\n");
+        return FAILED;
+    }
+    config::replicas = stoi(replicasString);
+    fprintf(stream, "Replicas :%u\n", config::replicas);
+    return SUCCESS;
+}
+
+int InflightInit(std::string inflightString, FILE *stream)
+{
+    const int MAX_INFLIGHT = 256;
+    if (!IsNumber(inflightString) || stoi(inflightString) == 0 || stoi(inflightString) > MAX_INFLIGHT) {
+        fprintf(stream, "[Error] Sorry, your input is illegal, please try again.\n"
+                "Options:\n"
+                "  --inflight     \n"
+                "  -f                   Requests in flight per replica, the next cases are loaded meanwhile, 1 to 256, default(1).\n"
+                "                       Up to thread_num of CUSTOMEngine in graph.config of them run at the same time.\n");
+        return FAILED;
+    }
+    config::inflight = stoi(inflightString);
+    fprintf(stream, "Inflight :%u\n", config::inflight);
+    return SUCCESS;
+}
+
+int DispatchInit(std::string dispatchString, FILE *stream)
+{
+    if (dispatchString == "rr") {
+        config::dispatchPolicy = DISPATCH_ROUND_ROBIN;
+    } else if (dispatchString == "least") {
+        config::dispatchPolicy = DISPATCH_LEAST_LOADED;
+    } else {
+        fprintf(stream, "[Error] Sorry, your input is illegal, please try again.\n"
+                "Options:\n"
+                "  --dispatch     \n"
+                "  -a                   Replica choice: rr for round-robin, least for least-loaded, default(rr).\n");
+        return FAILED;
+    }
+    fprintf(stream, "Dispatch :%s\n", dispatchString.c_str());
+    return SUCCESS;
+}
+
+int CacheInit(std::string cacheString, FILE *stream)
+{
+    if (cacheString == "use") {
+        config::cacheMode = CACHE_USE;
+    } else if (cacheString == "bypass") {
+        config::cacheMode = CACHE_BYPASS;
+    } else if (cacheString == "refresh") {
+        config::cacheMode = CACHE_REFRESH;
+    } else {
+        fprintf(stream, "[Error] Sorry, your input is illegal, please try again.\n"
+                "Options:\n"
+                "  --cache     \n"
+                "  -u                   Result cache: use, bypass, or refresh to rerun and overwrite stored results, default(use).\n");
+        return FAILED;
+    }
+    fprintf(stream, "Cache :%s\n", cacheString.c_str());
+    return SUCCESS;
+}
+
+int CompareInit(std::string compareString, FILE *stream)
+{
+    if (compareString == "device") {
+        config::hostCompare = false;
+    } else if (compareString == "host") {
+        config::hostCompare = true;
+    } else {
+        fprintf(stream, "[Error] Sorry, your input is illegal, please try again.\n"
+                "Options:\n"
+                "  --compare     \n"
+                "  -q                   Where outputs are compared with expect files: device, or host to send only inputs down, default(device).\n");
+        return FAILED;
+    }
+    fprintf(stream, "Compare :%s\n", compareString.c_str());
+    return SUCCESS;
+}
+
+int ReturnOutputsInit(std::string returnString, FILE *stream)
+{
+    if (returnString == "always") {
+        config::returnOutputs = RETURN_OUTPUTS_ALWAYS;
+    } else if (returnString == "on-fail") {
+        config::returnOutputs = RETURN_OUTPUTS_ON_FAIL;
+    } else if (returnString == "never") {
+        config::returnOutputs = RETURN_OUTPUTS_NEVER;
+    } else {
+        fprintf(stream, "[Error] Sorry, your input is illegal, please try again.\n"
+                "Options:\n"
+                "  --returnOutputs     \n"
+                "  -y                   Outputs returned and written: always, on-fail for failed compares only, or never, default(always).\n");
+        return FAILED;
+    }
+    fprintf(stream, "ReturnOutputs :%s\n", returnString.c_str());
+    return SUCCESS;
+}
+
+int CacheDirInit(std::string cacheDirString, FILE *stream)
+{
+    config::cacheDir = cacheDirString;
+    fprintf(stream, "CacheDir :%s\n", config::cacheDir.c_str());
+    return SUCCESS;
+}
+
+int DaemonInit(std::string socketString, FILE *stream)
+{
+    if (socketString.length() >= sizeof(((struct sockaddr_un*)0)->sun_path)) {
+        fprintf(stream, "[Error] Socket path %s is too long.\n", socketString.c_str());
+        return FAILED;
+    }
+    config::daemonSocket = socketString;
+    fprintf(stream, "Daemon :%s\n", config::daemonSocket.c_str());
+    return SUCCESS;
+}
+
+int SweepInit(std::string sweepString, FILE *stream)
+{
+    config::sweepFile = sweepString;
+    fprintf(stream, "Sweep :%s\n", config::sweepFile.c_str());
+    return SUCCESS;
+}
+
+int RuntimeInit(std::string runtimeString, FILE *stream)
+{
+    if (runtimeString == "device") {
+        config::hostRuntime = false;
+    } else if (runtimeString == "host") {
+        config::hostRuntime = true;
+    } else {
+        fprintf(stream, "[Error] Sorry, your input is illegal, please try again.\n"
+                "Options:\n"
+                "  --runtime     \n"
+                "  -j                   Where the sweep runs: device, or host for the CPU stand-in without a device, default(device).\n");
+        return FAILED;
+    }
+    fprintf(stream, "Runtime :%s\n", runtimeString.c_str());
+    return SUCCESS;
+}
+
+int ScratchInit(std::string scratchString, FILE *stream)
+{
+    int32_t backing = ParseScratchBacking(scratchString);
+    if (backing < 0) {
+        fprintf(stream, "[Error] Sorry, your input is illegal, please try again.\n"
+                "Options:\n"
+                "  --scratch     \n"
+                "  -l                   Backing of the device scratch files: disk for /tmp, tmpfs for " SCRATCH_TMPFS_DIR ",\n"
+                "                       or memfd for anonymous memory, default(disk).\n");
+        return FAILED;
+    }
+    config::scratchBacking = backing;
+    fprintf(stream, "Scratch :%s\n", scratchString.c_str());
+    return SUCCESS;
+}
+
+int ManifestInit(std::string manifestString, FILE *stream)
+{
+    config::manifestFile = manifestString;
+    fprintf(stream, "Manifest :%s\n", config::manifestFile.c_str());
+    return SUCCESS;
+}
+
 int ReadType(std::string param, char* argv, FILE *stream)
 {
     if ((param == "--kernalName") || (param ==  "-k")) {
@@ -611,6 +852,70 @@ int ReadType(std::string param, char* argv, FILE *stream)
         if (TypeInit(argv, stream) == SUCCESS) {
             return SUCCESS;
         }
+    } else if ((param ==  "--manifest") || (param == "-m")) {
+        if (ManifestInit(argv, stream) == SUCCESS) {
+            return SUCCESS;
+        }
+    } else if ((param ==  "--spec") || (param == "-s")) {
+        if (SpecInit(argv, stream) == SUCCESS) {
+            return SUCCESS;
+        }
+    } else if ((param ==  "--warmup") || (param == "-w")) {
+        if (WarmupInit(argv, stream) == SUCCESS) {
+            return SUCCESS;
+        }
+    } else if ((param ==  "--iterations") || (param == "-n")) {
+        if (IterationsInit(argv, stream) == SUCCESS) {
+            return SUCCESS;
+        }
+    } else if ((param ==  "--chunkSize") || (param == "-c")) {
+        if (ChunkSizeInit(argv, stream) == SUCCESS) {
+            return SUCCESS;
+        }
+    } else if ((param ==  "--replicas") || (param == "-r")) {
+        if (ReplicasInit(argv, stream) == SUCCESS) {
+            return SUCCESS;
+        }
+    } else if ((param ==  "--dispatch") || (param == "-a")) {
+        if (DispatchInit(argv, stream) == SUCCESS) {
+            return SUCCESS;
+        }
+    } else if ((param ==  "--inflight") || (param == "-f")) {
+        if (InflightInit(argv, stream) == SUCCESS) {
+            return SUCCESS;
+        }
+    } else if ((param ==  "--cache") || (param == "-u")) {
+        if (CacheInit(argv, stream) == SUCCESS) {
+            return SUCCESS;
+        }
+    } else if ((param ==  "--cacheDir") || (param == "-g")) {
+        if (CacheDirInit(argv, stream) == SUCCESS) {
+            return SUCCESS;
+        }
+    } else if ((param ==  "--compare") || (param == "-q")) {
+        if (CompareInit(argv, stream) == SUCCESS) {
+            return SUCCESS;
+        }
+    } else if ((param ==  "--returnOutputs") || (param == "-y")) {
+        if (ReturnOutputsInit(argv, stream) == SUCCESS) {
+            return SUCCESS;
+        }
+    } else if ((param ==  "--daemon") || (param == "-z")) {
+        if (DaemonInit(argv, stream) == SUCCESS) {
+            return SUCCESS;
+        }
+    } else if ((param ==  "--sweep") || (param == "-v")) {
+        if (SweepInit(argv, stream) == SUCCESS) {
+            return SUCCESS;
+        }
+    } else if ((param ==  "--runtime") || (param == "-j")) {
+        if (RuntimeInit(argv, stream) == SUCCESS) {
+            return SUCCESS;
+        }
+    } else if ((param ==  "--scratch") || (param == "-l")) {
+        if (ScratchInit(argv, stream) == SUCCESS) {
+            return SUCCESS;
+        }
     }
     return FAILED;
 }
@@ -640,6 +945,610 @@ int Initialization(int argc, char* argv[], FILE *stream)
     }
     return SUCCESS;
 }
+// clear per case settings before parsing the next manifest line
+void ResetCaseConfig()
+{
+    config::name = "";
+    config::type = RT_DEV_BINARY_MAGIC_ELF_AICPU_OPERATOR;
+    config::outputSizeList.clear();
+    config::binFile = "";
+    config::inputFileList.clear();
+    config::inputGeneratorList.clear();
+    config::outputFileList.clear();
+    config::workspaceSizeList.clear();
+    config::chainList.clear();
+    config::tapList.clear();
+    config::tapFileList.clear();
+    config::dataTypeList.clear();
+    config::precisionDeviation = 0.8;
+    config::statisticalDiscrepancy = 0.8;
+    config::expectFileList.clear();
+    config::warmup = 0;
+    config::iterations = 0;
+    config::hostCompare = config::baseHostCompare;
+    config::returnOutputs = config::baseReturnOutputs;
+    config::scratchBacking = config::baseScratchBacking;
+}
+
+std::shared_ptr<CustomInfo> BuildCustomInfo()
+{
+    shared_ptr<CustomInfo> customInfo = make_shared<CustomInfo>();
+    customInfo->name = config::name;
+    customInfo->type = config::type;
+    customInfo->outputSizeList = config::outputSizeList;
+    customInfo->returnOutputs = config::returnOutputs;
+    customInfo->scratchBacking = config::scratchBacking;
+    customInfo->workspaceSizeList = config::workspaceSizeList;
+    if (LoadFileBlob(config::binFile.c_str(), customInfo->binFile) != SUCCESS) {
+        fprintf(stdout, "[Error] Load bin file %s failed.\n", config::binFile.c_str());
+        return nullptr;
+    }
+
+	if (config::type==RT_DEV_BINARY_MAGIC_ELF_AICPU_OPERATOR){
+        if (LoadFileBlob(config::configFile.c_str(), customInfo->configFile) != SUCCESS) {
+            fprintf(stdout, "[Error] Load config file %s failed.\n", config::configFile.c_str());
+            return nullptr;
+        }
+    }
+    customInfo->inputGeneratorList = config::inputGeneratorList;
+    for (uint32_t j = 0; j < config::inputFileList.size(); j++) {
+        const std::string& in_file = config::inputFileList[j];
+        CustomFileBlob input = {0, nullptr};
+        if (j < config::inputGeneratorList.size() && config::inputGeneratorList[j].distribution != GEN_NONE) {
+            // expanded by CUSTOMEngine, nothing to send
+            customInfo->inputList.push_back(input);
+            continue;
+        }
+        if (LoadFileBlob(in_file.c_str(), input) != SUCCESS) {
+            fprintf(stdout, "[Error] Load input file %s failed.\n", in_file.c_str());
+            return nullptr;
+        }
+        customInfo->inputList.push_back(input);
+    }
+
+    for (auto& stageConfig : config::chainList) {
+        ChainStage stage;
+        stage.name = stageConfig.name;
+        stage.type = stageConfig.type;
+        stage.outputSizeList = stageConfig.outputSizeList;
+        stage.inputLinkList = stageConfig.inputLinkList;
+        stage.workspaceSizeList = stageConfig.workspaceSizeList;
+        if (LoadFileBlob(stageConfig.binFile.c_str(), stage.binFile) != SUCCESS) {
+            fprintf(stdout, "[Error] Load bin file %s failed.\n", stageConfig.binFile.c_str());
+            return nullptr;
+        }
+        for (auto& in_file : stageConfig.inputFileList) {
+            CustomFileBlob input = {0, nullptr};
+            if (!in_file.empty() && LoadFileBlob(in_file.c_str(), input) != SUCCESS) {
+                fprintf(stdout, "[Error] Load input file %s failed.\n", in_file.c_str());
+                return nullptr;
+            }
+            stage.inputList.push_back(input);
+        }
+        customInfo->chainList.push_back(stage);
+    }
+    customInfo->tapList = config::tapList;
+
+    customInfo->dataTypeList = config::dataTypeList;
+    customInfo->precisionDeviation = config::precisionDeviation;
+    customInfo->statisticalDiscrepancy = config::statisticalDiscrepancy;
+    for (auto& e_file : config::expectFileList) {
+        CustomFileBlob expect;
+        if (LoadFileBlob(e_file.c_str(), expect) != SUCCESS) {
+            fprintf(stdout, "[Error] Load expect file %s failed.\n", e_file.c_str());
+            return nullptr;
+        }
+        customInfo->expectFileList.push_back(expect);
+    }
+    return customInfo;
+}
+
+RunCase BuildRunCase(uint32_t index)
+{
+    RunCase runCase;
+    runCase.index = index;
+    runCase.customInfo = BuildCustomInfo();
+    runCase.outputFileList = config::outputFileList;
+    // tapped chain outputs come back after the final ones
+    runCase.outputFileList.insert(runCase.outputFileList.end(), config::tapFileList.begin(),
+                                  config::tapFileList.end());
+    runCase.hostCompare = config::hostCompare;
+    return runCase;
+}
+
+// mean of every device stage over results the device ran, cached ones carry no timing
+void PrintStageTiming(const std::vector<CaseResult>& results)
+{
+    std::vector<double> sum(6, 0);
+    uint32_t runNum = 0;
+    for (auto& result : results) {
+        if (!result.valid || result.cached) {
+            continue;
+        }
+        const StageTiming& timing = result.timing;
+        double stages[] = {timing.deserialize, timing.inputStaging, timing.binaryStaging, result.opRunTime,
+                           timing.readback, timing.compare};
+        for (uint32_t i = 0; i < sum.size(); i++) {
+            sum[i] += stages[i];
+        }
+        runNum++;
+    }
+    if (runNum == 0) {
+        return;
+    }
+    fprintf(stdout, "Device stages, mean of %u runs: deserialize %.3f, inputs %.3f, binaries %.3f, op_run %.3f, "
+            "readback %.3f, compare %.3f ms\n", runNum, sum[0] / runNum / 1000, sum[1] / runNum / 1000,
+            sum[2] / runNum / 1000, sum[3] / runNum / 1000, sum[4] / runNum / 1000, sum[5] / runNum / 1000);
+}
+
+void PrintLatencyStats(const char* label, std::vector<double> samples, uint64_t bytes)
+{
+    if (samples.empty()) {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        size_t rank = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+        return samples[rank];
+    };
+    double p50 = percentile(0.5);
+    fprintf(stdout, "%-10s min %.3f p50 %.3f p90 %.3f p99 %.3f max %.3f ms", label, samples.front(), p50,
+            percentile(0.9), percentile(0.99), samples.back());
+    if (p50 > 0) {
+        fprintf(stdout, ", %.3f GB/s at p50", bytes / (p50 * 1e6));
+    }
+    fprintf(stdout, "\n");
+}
+
+// re-send the same CustomInfo warmup + iterations times and report latency percentiles, returns the case status:
+// BENCHMARK, FAIL when a measured run did not match the expected output, or ERROR
+std::string RunBenchmark(OpDispatcher& dispatcher, const RunCase& runCase)
+{
+    if (runCase.customInfo == nullptr) {
+        return "ERROR";
+    }
+    uint64_t bytes = 0;
+    for (auto& input : runCase.customInfo->inputList) {
+        bytes += input.size;
+    }
+    for (auto outputSize : runCase.customInfo->outputSizeList) {
+        bytes += outputSize;
+    }
+
+    std::vector<double> endToEnd;
+    std::vector<double> opRun;
+    std::vector<CaseResult> measured;
+    for (uint32_t i = 0; i < config::warmup + config::iterations; i++) {
+        CaseResult result;
+        // a cached result would measure the disk, not the device
+        if (dispatcher.Submit(runCase, false) != SUCCESS || !dispatcher.Wait(runCase.index, result)) {
+            fprintf(stdout, "[Error] Benchmark run %u failed.\n", i);
+            return "ERROR";
+        }
+        if (i >= config::warmup) {
+            endToEnd.push_back(result.latencyMs);
+            opRun.push_back(result.opRunTime / 1000);
+            measured.push_back(result);
+        }
+    }
+    fprintf(stdout, "Benchmark %s: warmup %u, iterations %u, %lu bytes moved per run\n",
+            runCase.customInfo->name.c_str(), config::warmup, config::iterations, (unsigned long)bytes);
+    PrintLatencyStats("end2end", endToEnd, bytes);
+    PrintLatencyStats("op_run", opRun, bytes);
+    PrintStageTiming(measured);
+
+    uint32_t failNum = 0;
+    for (auto& result : measured) {
+        for (auto compareResult : result.compareResultList) {
+            if (!compareResult) {
+                failNum++;
+                break;
+            }
+        }
+    }
+    if (failNum > 0) {
+        fprintf(stdout, "[Error] Benchmark %s: %u of %u measured runs FAIL the compare.\n",
+                runCase.customInfo->name.c_str(), failNum, config::iterations);
+        return "FAIL";
+    }
+    return "BENCHMARK";
+}
+
+// split a manifest or job line at blanks, a word or part of it may be quoted with '' or "" to keep
+// blanks and the other quote in it
+int SplitJobLine(const std::string& line, std::vector<std::string>& words, FILE *stream)
+{
+    std::string word = "";
+    bool inWord = false;
+    char quote = 0;
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (quote != 0) {
+            if (c == quote) {
+                quote = 0;
+            } else {
+                word += c;
+            }
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+            inWord = true;
+        } else if (c == ' ' || c == '\t' || c == '\r') {
+            if (inWord) {
+                words.push_back(word);
+            }
+            word.clear();
+            inWord = false;
+        } else {
+            word += c;
+            inWord = true;
+        }
+    }
+    if (quote != 0) {
+        fprintf(stream, "[Error] Unterminated %c quote in line: %s\n", quote, line.c_str());
+        return FAILED;
+    }
+    if (inWord) {
+        words.push_back(word);
+    }
+    return SUCCESS;
+}
+
+// quote one argument for SplitJobLine, it comes back as it is whatever blanks or quotes it holds
+std::string QuoteJobWord(const std::string& word)
+{
+    std::string quoted = "'";
+    for (auto c : word) {
+        if (c == '\'') {
+            quoted += "'\"'\"'";
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "'";
+}
+
+// split one manifest line into an argv style list, argv[0] is the program name
+int ParseManifestLine(std::string line, char* program, FILE *stream)
+{
+    std::vector<std::string> words;
+    if (SplitJobLine(line, words, stream) != SUCCESS) {
+        return FAILED;
+    }
+    std::vector<char*> argv;
+    argv.push_back(program);
+    for (uint32_t i = 0; i < words.size(); i++) {
+        std::string& w = words[i];
+        // options only, the word after each one is its value
+        bool option = (i % 2 == 0);
+        if (option && ((w == "--manifest") || (w == "-m"))) {
+            fprintf(stream, "[Error] Nested manifest is not supported.\n");
+            return FAILED;
+        }
+        if (option && ((w == "--daemon") || (w == "-z") || (w == "--connect") || (w == "-x") || (w == "--sweep") ||
+            (w == "-v") || (w == "--runtime") || (w == "-j"))) {
+            fprintf(stream, "[Error] %s is not supported inside a job.\n", w.c_str());
+            return FAILED;
+        }
+        // the dispatcher and the result cache are built once for every case of the run
+        if (option && ((w == "--replicas") || (w == "-r") || (w == "--inflight") || (w == "-f") ||
+            (w == "--chunkSize") || (w == "-c") || (w == "--dispatch") || (w == "-a") || (w == "--cache") ||
+            (w == "-u") || (w == "--cacheDir") || (w == "-g"))) {
+            fprintf(stream, "[Error] %s applies to the whole run, give it on the command line instead.\n",
+                    w.c_str());
+            return FAILED;
+        }
+        argv.push_back(&w[0]);
+    }
+    return Initialization(argv.size(), argv.data(), stream);
+}
+
+std::string CaseStatus(bool received, const CaseResult& result)
+{
+    if (!received) {
+        return "ERROR";
+    }
+    std::string status = result.compareResultList.empty() ? "NO_CHECK" : "PASS";
+    for (auto compareResult : result.compareResultList) {
+        if (!compareResult) {
+            status = "FAIL";
+        }
+    }
+    return status;
+}
+
+// summary line of one manifest case, kept until the case is written in order
+struct ManifestEntry
+{
+    std::string name;
+    std::string status;
+    double latencyMs;
+    bool submitted;
+    bool cached;
+    CaseResult result;  // as received, for the stage timing over the manifest
+};
+
+// wait for the submitted cases from entry first on, in manifest order
+void CollectManifestResults(OpDispatcher& dispatcher, std::vector<ManifestEntry>& entries, uint32_t first)
+{
+    for (uint32_t i = first; i < entries.size(); i++) {
+        if (!entries[i].submitted) {
+            continue;
+        }
+        CaseResult result;
+        bool received = dispatcher.Wait(i, result);
+        entries[i].status = CaseStatus(received, result);
+        entries[i].latencyMs = result.latencyMs;
+        entries[i].cached = result.cached;
+        entries[i].result = result;
+        entries[i].submitted = false;
+    }
+}
+
+// run every case of the manifest through the live graphs and write one summary
+int RunManifest(OpDispatcher& dispatcher, char* program)
+{
+    ifstream manifest(config::manifestFile);
+    if (manifest.fail()) {
+        fprintf(stdout, "[Error] Open manifest %s failed.\n", config::manifestFile.c_str());
+        return FAILED;
+    }
+    std::string summaryFileName = "./output/manifestSummary.txt";
+    std::ofstream summary(summaryFileName);
+    if (!summary.is_open()) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to open summary file %s!", summaryFileName.c_str());
+        return FAILED;
+    }
+
+    std::vector<ManifestEntry> entries;
+    uint32_t collected = 0;
+    std::string line = "";
+    while (getline(manifest, line)) {
+        if (line.find_first_not_of(" \t\r") == string::npos || line[line.find_first_not_of(" \t")] == '#') {
+            continue;
+        }
+        ResetCaseConfig();
+        uint32_t caseIndex = entries.size();
+        entries.push_back({"", "ERROR", 0, false, false});
+        if (ParseManifestLine(line, program, stdout) != SUCCESS) {
+            continue;
+        }
+        entries[caseIndex].name = config::name;
+        if (config::iterations > 0) {
+            // benchmarks measure an otherwise idle device
+            CollectManifestResults(dispatcher, entries, collected);
+            collected = entries.size();
+            entries[caseIndex].status = RunBenchmark(dispatcher, BuildRunCase(caseIndex));
+            continue;
+        }
+        entries[caseIndex].submitted = (dispatcher.Submit(BuildRunCase(caseIndex)) == SUCCESS);
+    }
+    CollectManifestResults(dispatcher, entries, collected);
+
+    uint32_t passNum = 0;
+    uint32_t failNum = 0;
+    for (uint32_t i = 0; i < entries.size(); i++) {
+        const ManifestEntry& entry = entries[i];
+        if (entry.status == "PASS" || entry.status == "NO_CHECK" || entry.status == "BENCHMARK") {
+            passNum++;
+        } else {
+            failNum++;
+        }
+        summary << "Case " << i << " " << entry.name << " " << entry.status << " " << entry.latencyMs << " ms"
+                << (entry.cached ? " cached\n" : "\n");
+    }
+    summary << "Total " << entries.size() << " passed " << passNum << " failed " << failNum << "\n";
+    summary.close();
+    std::cout << "Manifest finished, total " << entries.size() << ", passed " << passNum << ", failed " << failNum
+              << ", see " << summaryFileName << std::endl;
+    std::vector<CaseResult> results;
+    for (auto& entry : entries) {
+        results.push_back(entry.result);
+    }
+    PrintStageTiming(results);
+    return (failNum == 0) ? SUCCESS : FAILED;
+}
+
+namespace daemonState
+{
+    static std::mutex   jobMutex;  // config and Submit are shared by all client threads
+    static uint32_t     nextIndex = 0;
+    static int          listenFd  = -1;
+}  // namespace daemonState
+
+void DaemonSignalHandler(int)
+{
+    // wakes up accept, the daemon then stops the graph
+    shutdown(daemonState::listenFd, SHUT_RDWR);
+}
+
+// one client connection, fd stays open until the thread is joined so shutdown never hits a reused fd
+struct DaemonClient
+{
+    std::thread thread;
+    int fd;
+    std::shared_ptr< std::atomic<bool> > finished;
+};
+
+// run the jobs of one client connection in order, each job is answered with
+// its messages followed by one "Case <index> <name> <status> <latency> ms" line
+void ServeDaemonClient(OpDispatcher& dispatcher, int fd, char* program, std::shared_ptr< std::atomic<bool> > finished)
+{
+    FILE* in = fdopen(dup(fd), "r");
+    FILE* out = fdopen(dup(fd), "w");
+    if (in == NULL || out == NULL) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to open client connection.");
+        if (out != NULL) {
+            fclose(out);
+        }
+        if (in != NULL) {
+            fclose(in);
+        }
+        shutdown(fd, SHUT_RDWR);
+        *finished = true;
+        return;
+    }
+    setvbuf(out, NULL, _IOLBF, 0);
+    std::string line = "";
+    int c = 0;
+    while ((c = fgetc(in)) != EOF) {
+        if (c != '\n') {
+            line += (char)c;
+            continue;
+        }
+        if (line.find_first_not_of(" \t\r") == string::npos) {
+            line.clear();
+            continue;
+        }
+        uint32_t index = 0;
+        std::string name = "";
+        std::string status = "ERROR";
+        bool submitted = false;
+        {
+            std::unique_lock <std::mutex> lck(daemonState::jobMutex);
+            index = daemonState::nextIndex++;
+            ResetCaseConfig();
+            if (ParseManifestLine(line, program, out) == SUCCESS) {
+                name = config::name;
+                if (config::iterations > 0) {
+                    // the benchmark keeps the other clients waiting, it measures an otherwise idle device
+                    status = RunBenchmark(dispatcher, BuildRunCase(index));
+                } else {
+                    submitted = (dispatcher.Submit(BuildRunCase(index)) == SUCCESS);
+                }
+            }
+        }
+        CaseResult result;
+        if (submitted) {
+            status = CaseStatus(dispatcher.Wait(index, result), result);
+        }
+        fprintf(out, "Case %u %s %s %.3f ms%s\n", index, name.c_str(), status.c_str(), result.latencyMs,
+                result.cached ? " cached" : "");
+        line.clear();
+    }
+    fclose(in);
+    fclose(out);
+    // the client reads until EOF, fd itself is closed once the thread is joined
+    shutdown(fd, SHUT_RDWR);
+    *finished = true;
+}
+
+// keep the graphs alive and serve jobs from any number of local clients
+int RunDaemon(OpDispatcher& dispatcher, char* program)
+{
+    daemonState::listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (daemonState::listenFd < 0) {
+        fprintf(stdout, "[Error] Create socket failed.\n");
+        return FAILED;
+    }
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, config::daemonSocket.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(config::daemonSocket.c_str());
+    const int BACKLOG = 16;
+    if (bind(daemonState::listenFd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(daemonState::listenFd, BACKLOG) != 0) {
+        fprintf(stdout, "[Error] Listen on %s failed.\n", config::daemonSocket.c_str());
+        close(daemonState::listenFd);
+        return FAILED;
+    }
+    signal(SIGINT, DaemonSignalHandler);
+    signal(SIGTERM, DaemonSignalHandler);
+    signal(SIGPIPE, SIG_IGN);
+    std::cout << "Daemon listening on " << config::daemonSocket << std::endl;
+
+    std::list<DaemonClient> clients;
+    while (true) {
+        int fd = accept(daemonState::listenFd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (auto it = clients.begin(); it != clients.end();) {
+            if (!*it->finished) {
+                it++;
+                continue;
+            }
+            it->thread.join();
+            close(it->fd);
+            it = clients.erase(it);
+        }
+        std::shared_ptr< std::atomic<bool> > finished = std::make_shared< std::atomic<bool> >(false);
+        clients.push_back({std::thread(ServeDaemonClient, std::ref(dispatcher), fd, program, finished), fd, finished});
+    }
+    // clients finish the job they are waiting for and read no further, the dispatcher
+    // must outlive them
+    for (auto& client : clients) {
+        shutdown(client.fd, SHUT_RDWR);
+    }
+    for (auto& client : clients) {
+        client.thread.join();
+        close(client.fd);
+    }
+    close(daemonState::listenFd);
+    unlink(config::daemonSocket.c_str());
+    std::cout << "Daemon stopped." << std::endl;
+    return SUCCESS;
+}
+
+// --connect: send the remaining options as one job and print the reply
+int RunClient(const std::string& socketPath, int argc, char* argv[])
+{
+    std::string job = "";
+    for (int i = 1; i < argc; i++) {
+        std::string param(argv[i]);
+        if ((param == "--connect") || (param == "-x")) {
+            i++;
+            continue;
+        }
+        // the daemon reads one job per line
+        if (param.find('\n') != string::npos) {
+            fprintf(stdout, "[Error] Option %s holds a line break.\n", param.c_str());
+            return FAILED;
+        }
+        job += QuoteJobWord(param) + " ";
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        fprintf(stdout, "[Error] Connect to daemon %s failed.\n", socketPath.c_str());
+        if (fd >= 0) {
+            close(fd);
+        }
+        return FAILED;
+    }
+    job += "\n";
+    if (write(fd, job.c_str(), job.length()) != (ssize_t)job.length()) {
+        fprintf(stdout, "[Error] Send job to daemon failed.\n");
+        close(fd);
+        return FAILED;
+    }
+    shutdown(fd, SHUT_WR);
+
+    std::string reply = "";
+    char buffer[4096];
+    ssize_t n = 0;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+        reply.append(buffer, n);
+    }
+    close(fd);
+    fprintf(stdout, "%s", reply.c_str());
+
+    size_t lastLine = reply.rfind("Case ");
+    if (lastLine == string::npos) {
+        return FAILED;
+    }
+    std::istringstream result(reply.substr(lastLine));
+    std::string word;
+    std::string status;
+    result >> word >> word >> word >> status;
+    return (status == "PASS" || status == "NO_CHECK" || status == "BENCHMARK") ? SUCCESS : FAILED;
+}
+
 // main
 int main(int argc, char* argv[])
 {
@@ -650,74 +1559,70 @@ int main(int argc, char* argv[])
             return SUCCESS;
         }
     }
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string param(argv[i]);
+        if ((param == "--connect") || (param == "-x")) {
+            return RunClient(argv[i + 1], argc, argv);
+        }
+    }
     if (Initialization(argc, argv, stdout) != SUCCESS) {
         return FAILED;
     }
+    config::baseHostCompare = config::hostCompare;
+    config::baseReturnOutputs = config::returnOutputs;
+    config::baseScratchBacking = config::scratchBacking;
     std::cout << "If you prefer to see log, please open log tab in MindStudio.";
     HIAI_ENGINE_LOG(HIAI_IDE_INFO, "Start to run ...");
+    if (!config::sweepFile.empty() && config::hostRuntime) {
+        // the stand-in needs no graph
+        return RunSweep(config::sweepFile, nullptr, config::configFile, config::scratchBacking);
+    }
 
     HIAI_StatusT ret = HIAI_OK;
 
     // Perform Initialziation
-    ret = HIAI_InitAndStartGraph();
-
+    OpDispatcher dispatcher(config::replicas, config::inflight, config::dispatchPolicy, config::chunkSize);
+    ResultCache resultCache(config::cacheDir, config::cacheMode);
+    dispatcher.SetResultCache(&resultCache);
+    bool watchDisconnect = (config::type == RT_DEV_BINARY_MAGIC_ELF) ||
+                           (config::type == RT_DEV_BINARY_MAGIC_ELF_AICPU) || (!config::manifestFile.empty()) ||
+                           (!config::daemonSocket.empty()) || (!config::sweepFile.empty());
+    ret = dispatcher.Start(graph_config_proto_file, watchDisconnect);
 
     if (HIAI_OK != ret) {
         HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to start graph.");
         // Now Stop the whole graph
-        hiai::Graph::DestroyGraph(GRAPH_ID);
-        return FAILED;
-    }
-
-    std::shared_ptr<hiai::Graph> graph = hiai::Graph::GetInstance(GRAPH_ID);
-    if (nullptr == graph) {
-        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to get the graph-%u.", GRAPH_ID);
-        hiai::Graph::DestroyGraph(GRAPH_ID);
+        dispatcher.Stop();
         return FAILED;
     }
     HIAI_ENGINE_LOG(HIAI_IDE_INFO, "Successed to to start graph.");
 
-    // SourceEngine 0 port
-    hiai::EnginePortID engine_id{.graph_id = GRAPH_ID, .engine_id = SRC_ENGINE_ID, .port_id = SRC_PORT_ID};
-
-    shared_ptr<CustomInfo> customInfo = make_shared<CustomInfo>();
-    customInfo->name = config::name;
-    customInfo->type = config::type;
-    customInfo->outputSizeList = config::outputSizeList;
-    uint32_t buffer_size = 0;
-    char * binFile = ReadFile(config::binFile.c_str(), &buffer_size);
-    customInfo->binFile = {buffer_size, shared_ptr<char>(binFile)};
-
-	if (config::type==RT_DEV_BINARY_MAGIC_ELF_AICPU_OPERATOR){
-        char * configFile = ReadFile(config::configFile.c_str(), &buffer_size);
-        customInfo->configFile = {buffer_size, shared_ptr<char>(configFile)};
-    }
-    for (auto& in_file : config::inputFileList) {
-        char * input1 = ReadFile(in_file.c_str(), &buffer_size);
-        customInfo->inputList.push_back({buffer_size, shared_ptr<char>(input1)});
-    }
-
-    customInfo->dataTypeList = config::dataTypeList;
-    customInfo->precisionDeviation = config::precisionDeviation;
-    customInfo->statisticalDiscrepancy = config::statisticalDiscrepancy;
-    for (auto& e_file : config::expectFileList) {
-        char * expexct = ReadFile(e_file.c_str(), &buffer_size);
-        customInfo->expectFileList.push_back({buffer_size, shared_ptr<char>(expexct)});
+    int runResult = SUCCESS;
+    if (!config::daemonSocket.empty()) {
+        runResult = RunDaemon(dispatcher, argv[0]);
+    } else if (!config::sweepFile.empty()) {
+        runResult = RunSweep(config::sweepFile, &dispatcher, config::configFile, config::scratchBacking);
+    } else if (!config::manifestFile.empty()) {
+        runResult = RunManifest(dispatcher, argv[0]);
+    } else if (config::iterations > 0) {
+        runResult = (RunBenchmark(dispatcher, BuildRunCase(0)) == "BENCHMARK") ? SUCCESS : FAILED;
+    } else {
+        CaseResult result;
+        runResult = FAILED;
+        if (dispatcher.Submit(BuildRunCase(0)) == SUCCESS && dispatcher.Wait(0, result)) {
+            runResult = SUCCESS;
+            if (result.cached) {
+                std::cout << "Result served from cache " << config::cacheDir << "." << std::endl;
+            }
+            std::cout << "Send to receive latency: " << result.latencyMs << " ms, op run "
+                      << result.opRunTime / 1000 << " ms" << std::endl;
+            PrintStageTiming({result});
+        }
     }
 
-    graph->SendData(engine_id, "string", std::static_pointer_cast<void>(customInfo));
-
-    // Wait for result
-    std::thread check_thread(checkDestFileExist);
-    check_thread.join();
-    std::unique_lock <std::mutex> lck(localTestMutex);
-    localTestCv.wait_for(lck, std::chrono::seconds(MAX_SLEEP_TIMER), [] { return isTestResultReady; });
-
     // Now Stop the whole graph
-    hiai::Graph::DestroyGraph(GRAPH_ID);
+    dispatcher.Stop();
     std::cout << "RUN Finished." << std::endl;
     HIAI_ENGINE_LOG(HIAI_IDE_INFO, "RUN Finished.");
-    return SUCCESS;
+    return runResult;
 }
-
-
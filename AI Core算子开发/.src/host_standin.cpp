@@ -0,0 +1,114 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#include "host_standin.h"
+#include <math.h>
+#include <string.h>
+#include "input_generator.h"
+
+#define SUCCESS 0
+#define FAILED -1
+
+static double LoadElem(int32_t elemType, const char* data, uint64_t i)
+{
+    if (elemType == GEN_FLOAT16) {
+        uint16_t half = 0;
+        memcpy(&half, data + i * sizeof(half), sizeof(half));
+        return HalfToFloat(half);
+    }
+    float value = 0;
+    memcpy(&value, data + i * sizeof(value), sizeof(value));
+    return value;
+}
+
+static void StoreElem(int32_t elemType, char* data, uint64_t i, double value)
+{
+    if (elemType == GEN_FLOAT16) {
+        uint16_t half = FloatToHalf((float)value);
+        memcpy(data + i * sizeof(half), &half, sizeof(half));
+        return;
+    }
+    float f = (float)value;
+    memcpy(data + i * sizeof(f), &f, sizeof(f));
+}
+
+int32_t HostReduction(const std::vector<int64_t>& shape, int32_t axis, const std::string& op, float coeff,
+                      int32_t elemType, const char* input, char* output)
+{
+    int32_t rank = (int32_t)shape.size();
+    if ((elemType != GEN_FLOAT16 && elemType != GEN_FLOAT32) || axis >= rank || axis < -rank) {
+        return FAILED;
+    }
+    if (axis < 0) {
+        axis += rank;
+    }
+    uint64_t outer = 1;
+    uint64_t inner = 1;
+    for (int32_t d = 0; d < rank; d++) {
+        (d < axis ? outer : inner) *= (uint64_t)shape[d];
+    }
+    bool absolute = (op == "ASUM");
+    bool square = (op == "SUMSQ");
+    for (uint64_t o = 0; o < outer; o++) {
+        double sum = 0;
+        for (uint64_t i = o * inner; i < (o + 1) * inner; i++) {
+            double value = LoadElem(elemType, input, i);
+            sum += absolute ? fabs(value) : (square ? value * value : value);
+        }
+        sum *= coeff;
+        if (op == "MEAN") {
+            sum /= (double)inner;
+        }
+        StoreElem(elemType, output, o, sum);
+    }
+    return SUCCESS;
+}
+
+ConvShape MakeConvShape(const std::vector<int64_t>& dims)
+{
+    ConvShape shape = {dims[0], dims[1], dims[2], dims[3], dims[4], dims[5], dims[6], dims[7], dims[8]};
+    return shape;
+}
+
+int32_t HostConv2d(const ConvShape& shape, int32_t elemType, const char* input, const char* weight, char* output)
+{
+    if ((elemType != GEN_FLOAT16 && elemType != GEN_FLOAT32) || shape.stride <= 0) {
+        return FAILED;
+    }
+    int64_t outH = shape.OutH();
+    int64_t outW = shape.OutW();
+    uint64_t o = 0;
+    for (int64_t n = 0; n < shape.n; n++) {
+        for (int64_t co = 0; co < shape.cout; co++) {
+            for (int64_t oh = 0; oh < outH; oh++) {
+                for (int64_t ow = 0; ow < outW; ow++) {
+                    double sum = 0;
+                    for (int64_t ci = 0; ci < shape.cin; ci++) {
+                        for (int64_t kh = 0; kh < shape.kh; kh++) {
+                            int64_t ih = oh * shape.stride - shape.pad + kh;
+                            if (ih < 0 || ih >= shape.h) {
+                                continue;
+                            }
+                            for (int64_t kw = 0; kw < shape.kw; kw++) {
+                                int64_t iw = ow * shape.stride - shape.pad + kw;
+                                if (iw < 0 || iw >= shape.w) {
+                                    continue;
+                                }
+                                uint64_t x = ((n * shape.cin + ci) * shape.h + ih) * shape.w + iw;
+                                uint64_t k = ((co * shape.cin + ci) * shape.kh + kh) * shape.kw + kw;
+                                sum += LoadElem(elemType, input, x) * LoadElem(elemType, weight, k);
+                            }
+                        }
+                    }
+                    StoreElem(elemType, output, o++, sum);
+                }
+            }
+        }
+    }
+    return SUCCESS;
+}
@@ -0,0 +1,177 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#include "input_generator.h"
+#include <math.h>
+#include <string.h>
+#include <memory>
+#include "custom_common.h"
+
+#define SUCCESS 0
+#define FAILED -1
+
+static const uint64_t GENERATE_BLOCK_ELEMS = 1024 * 1024;
+
+// splitmix64 of the element counter, independent of how the stream is split into blocks
+static uint64_t StreamBits(uint64_t seed, uint64_t counter)
+{
+    uint64_t z = seed + (counter + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// 24 random bits scaled to [0, 1), exact in float
+static double StreamUniform(uint64_t seed, uint64_t counter)
+{
+    return (double)(StreamBits(seed, counter) >> 40) / (double)(1 << 24);
+}
+
+static double GenerateValue(const InputGenerator& generator, uint64_t i)
+{
+    switch (generator.distribution) {
+        case GEN_UNIFORM:
+            return generator.param0 + (generator.param1 - (double)generator.param0) * StreamUniform(generator.seed, i);
+        case GEN_NORMAL: {
+            // Box-Muller on counters 2i and 2i + 1, u1 in (0, 1]
+            double u1 = 1.0 - StreamUniform(generator.seed, 2 * i);
+            double u2 = StreamUniform(generator.seed, 2 * i + 1);
+            return generator.param0 + generator.param1 * sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+        }
+        case GEN_CONSTANT:
+            return generator.param0;
+        case GEN_RAMP:
+            return generator.param0 + (double)generator.param1 * (double)i;
+        default:
+            return 0;
+    }
+}
+
+float HalfToFloat(uint16_t half)
+{
+    uint32_t sign = (half >> 15) & 0x1;
+    int32_t exponent = (half >> 10) & 0x1f;
+    uint32_t mantissa = half & 0x3ff;
+    float value = 0;
+    if (exponent == 0) {
+        value = ldexpf((float)mantissa, -24);  // zero and subnormals
+    } else if (exponent == 0x1f) {
+        value = (mantissa == 0) ? INFINITY : NAN;
+    } else {
+        value = ldexpf((float)(mantissa | 0x400), exponent - 25);
+    }
+    return sign ? -value : value;
+}
+
+// round to nearest even, overflow to infinity
+uint16_t FloatToHalf(float value)
+{
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = (int32_t)((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+    if (((bits >> 23) & 0xff) == 0xff) {
+        return sign | 0x7c00 | (mantissa ? 0x200 : 0);  // inf or nan
+    }
+    if (exponent >= 0x1f) {
+        return sign | 0x7c00;
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return sign;
+        }
+        mantissa |= 0x800000;
+        uint32_t shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1))) {
+            half++;
+        }
+        return sign | half;
+    }
+    uint32_t half = ((uint32_t)exponent << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+        half++;  // may carry into the exponent, which is still correct
+    }
+    return sign | half;
+}
+
+template<class T>
+static T Saturate(double value, double low, double high)
+{
+    if (isnan(value)) {
+        return 0;
+    }
+    value = nearbyint(value);
+    return (T)(value < low ? low : (value > high ? high : value));
+}
+
+uint32_t GeneratorElemSize(int32_t elemType)
+{
+    switch (elemType) {
+        case GEN_FLOAT32: return sizeof(float);
+        case GEN_FLOAT16: return sizeof(uint16_t);
+        case GEN_INT32: return sizeof(int32_t);
+        case GEN_INT8: return sizeof(int8_t);
+        case GEN_UINT8: return sizeof(uint8_t);
+        default: return 0;
+    }
+}
+
+int32_t GenerateElements(const InputGenerator& generator, uint64_t firstElem, uint64_t elemNum, char* out)
+{
+    uint32_t elemSize = GeneratorElemSize(generator.elemType);
+    if (elemSize == 0 || generator.distribution == GEN_NONE || generator.distribution > GEN_RAMP) {
+        return FAILED;
+    }
+    for (uint64_t n = 0; n < elemNum; n++) {
+        double value = GenerateValue(generator, firstElem + n);
+        char* elem = out + n * elemSize;
+        if (generator.elemType == GEN_FLOAT32) {
+            float f = (float)value;
+            memcpy(elem, &f, sizeof(f));
+        } else if (generator.elemType == GEN_FLOAT16) {
+            uint16_t h = FloatToHalf((float)value);
+            memcpy(elem, &h, sizeof(h));
+        } else if (generator.elemType == GEN_INT32) {
+            int32_t v = Saturate<int32_t>(value, INT32_MIN, INT32_MAX);
+            memcpy(elem, &v, sizeof(v));
+        } else if (generator.elemType == GEN_INT8) {
+            *elem = (char)Saturate<int8_t>(value, INT8_MIN, INT8_MAX);
+        } else {
+            *elem = (char)Saturate<uint8_t>(value, 0, UINT8_MAX);
+        }
+    }
+    return SUCCESS;
+}
+
+int32_t WriteGeneratedInput(const char* fileName, const InputGenerator& generator)
+{
+    uint32_t elemSize = GeneratorElemSize(generator.elemType);
+    if (fileName == NULL || elemSize == 0) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Invalid generator param!");
+        return FAILED;
+    }
+    uint64_t blockElems = (generator.elemNum < GENERATE_BLOCK_ELEMS) ? generator.elemNum : GENERATE_BLOCK_ELEMS;
+    std::unique_ptr<char[]> block(new char[blockElems * elemSize + 1]);
+    if (generator.elemNum == 0) {
+        return WriteFileAt(fileName, block.get(), 0, 0, true);
+    }
+    for (uint64_t first = 0; first < generator.elemNum; first += blockElems) {
+        uint64_t count = (generator.elemNum - first < blockElems) ? generator.elemNum - first : blockElems;
+        if (GenerateElements(generator, first, count, block.get()) != SUCCESS ||
+            WriteFileAt(fileName, block.get(), count * elemSize, first * elemSize, first == 0) != SUCCESS) {
+            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Generate input %s failed!", fileName);
+            return FAILED;
+        }
+    }
+    return SUCCESS;
+}
@@ -0,0 +1,58 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#include "kernel_cache.h"
+#include <stdio.h>
+
+std::shared_ptr<OpBuffer> KernelCache::Get(uint64_t hash)
+{
+    std::unique_lock <std::mutex> lck(mutex);
+    auto it = entries.find(hash);
+    if (it == entries.end()) {
+        return nullptr;
+    }
+    lruList.splice(lruList.begin(), lruList, it->second.lru);
+    return it->second.buffer;
+}
+
+std::shared_ptr<OpBuffer> KernelCache::Put(uint64_t hash, const CustomFileBlob& blob, bool toFile, int32_t backing)
+{
+    if (HashBytes(blob.data.get(), blob.size, 0) != hash) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Kernel blob of %llu bytes does not match hash %016llx.",
+                        (unsigned long long)blob.size, (unsigned long long)hash);
+        return nullptr;
+    }
+    std::unique_lock <std::mutex> lck(mutex);
+    auto it = entries.find(hash);
+    if (it != entries.end()) {
+        lruList.splice(lruList.begin(), lruList, it->second.lru);
+        return it->second.buffer;
+    }
+    char name[48];
+    snprintf(name, sizeof(name), "op_kernel_%016llx", (unsigned long long)hash);
+    std::shared_ptr<OpBuffer> buffer = std::make_shared<OpBuffer>(name, blob);
+    std::string fileName;
+    // staged before it is shared, so readers never race on the file view
+    if (toFile && buffer->File(fileName, backing) != 0) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to stage kernel file %s.", name);
+        return nullptr;
+    }
+    lruList.push_front(hash);
+    entries[hash] = {buffer, lruList.begin()};
+    bytes += blob.size;
+    // entries still used by a running request live on until it drops them
+    while (bytes > maxBytes && lruList.size() > 1) {
+        auto last = entries.find(lruList.back());
+        bytes -= last->second.buffer->Size();
+        entries.erase(last);
+        lruList.pop_back();
+    }
+    HIAI_ENGINE_LOG(HIAI_IDE_INFO, "Cached kernel %016llx, %llu bytes in cache.", (unsigned long long)hash,
+                    (unsigned long long)bytes);
+    return buffer;
+}
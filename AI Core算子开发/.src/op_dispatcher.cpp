@@ -0,0 +1,570 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#include "op_dispatcher.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include "error_code.h"
+
+#define SUCCESS 0
+#define FAILED -1
+
+static const std::string REPLICA_GRAPH_CONFIG = "./graph_replicas.config";
+static OpDispatcher* activeDispatcher = nullptr;
+static const uint32_t OUTPUT_WRITER_THREADS = 4;
+
+// Define Data Recv Interface
+class DdkDataRecvInterface : public hiai::DataRecvInterface
+{
+public:
+    DdkDataRecvInterface(OpDispatcher* dispatcher, uint32_t replica) : dispatcher(dispatcher), replica(replica)
+    {
+    }
+    ~DdkDataRecvInterface()
+    {
+    }
+
+    /**
+    * @ingroup hiaiengine
+    * @brief
+    * @param [in]
+    * @return HIAI Status
+    */
+    HIAI_StatusT RecvData(const std::shared_ptr<void>& message)
+    {
+        std::chrono::steady_clock::time_point recvTime = std::chrono::steady_clock::now();
+        HIAI_ENGINE_LOG(HIAI_IDE_INFO, "Receive data from replica %u.", replica);
+
+        std::shared_ptr<CustomOutput> customOutput =
+            std::static_pointer_cast<CustomOutput>(message);
+        if (customOutput == nullptr) {
+            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Fail to receive data");
+        }
+        dispatcher->OnResult(replica, customOutput, recvTime);
+        return (customOutput == nullptr) ? HIAI_INVALID_INPUT_MSG : HIAI_OK;
+    }
+private:
+    OpDispatcher* dispatcher;
+    uint32_t replica;
+};
+
+// if device is disconnected, fail everything in flight
+HIAI_StatusT DeviceDisconnectCallBack()
+{
+    if (activeDispatcher != nullptr) {
+        activeDispatcher->OnDisconnect();
+    }
+    return HIAI_OK;
+}
+
+// write graphConfigFile once per replica with graph ids GRAPH_ID, GRAPH_ID + 1, ...
+static int WriteReplicaGraphConfig(const std::string& graphConfigFile, uint32_t replicaNum)
+{
+    std::ifstream file(graphConfigFile);
+    if (file.fail()) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to open graph config %s.", graphConfigFile.c_str());
+        return FAILED;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    std::string graphText = text.str();
+
+    const std::string key = "graph_id:";
+    size_t keyPos = graphText.find(key);
+    if (keyPos == std::string::npos) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "No graph_id in graph config %s.", graphConfigFile.c_str());
+        return FAILED;
+    }
+    size_t idBegin = graphText.find_first_not_of(" \t", keyPos + key.length());
+    size_t idEnd = graphText.find_first_not_of("0123456789", idBegin);
+
+    std::ofstream replicaFile(REPLICA_GRAPH_CONFIG);
+    if (!replicaFile.is_open()) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to write graph config %s.", REPLICA_GRAPH_CONFIG.c_str());
+        return FAILED;
+    }
+    for (uint32_t r = 0; r < replicaNum; r++) {
+        replicaFile << graphText.substr(0, idBegin) << (GRAPH_ID + r) << graphText.substr(idEnd) << "\n";
+    }
+    replicaFile.close();
+    return SUCCESS;
+}
+
+OpDispatcher::OpDispatcher(uint32_t replicaNum, uint32_t inFlightLimit, DispatchPolicy policy, uint64_t chunkSize)
+    : policy(policy), chunkSize(chunkSize), inFlightLimit(std::max(inFlightLimit, 1u)),
+      replicas(std::max(replicaNum, 1u)), writer(OUTPUT_WRITER_THREADS)
+{
+    for (uint32_t r = 0; r < replicas.size(); r++) {
+        replicas[r].graphId = GRAPH_ID + r;
+    }
+}
+
+// Init and create graph
+HIAI_StatusT OpDispatcher::Start(const std::string& graphConfigFile, bool watchDisconnect)
+{
+    // Step1: Global System Initialization before using HIAI Engine
+    HIAI_StatusT status = HIAI_Init(0);
+
+    // Step2: Create and Start the Graph
+    std::string configFile = graphConfigFile;
+    if (replicas.size() > 1) {
+        if (WriteReplicaGraphConfig(graphConfigFile, replicas.size()) != SUCCESS) {
+            return HIAI_ERROR;
+        }
+        configFile = REPLICA_GRAPH_CONFIG;
+    }
+    status = hiai::Graph::CreateGraph(configFile);
+    if (status != HIAI_OK) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to start graph.");
+        return status;
+    }
+
+    // Step3: hook every replica
+    activeDispatcher = this;
+    for (uint32_t r = 0; r < replicas.size(); r++) {
+        std::shared_ptr<hiai::Graph> graph = hiai::Graph::GetInstance(replicas[r].graphId);
+        if (nullptr == graph) {
+            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to get the graph-%u.", replicas[r].graphId);
+            return HIAI_ERROR;
+        }
+
+        hiai::EnginePortID target_port_config{.graph_id = replicas[r].graphId, .engine_id = DST_ENGINE_ID,
+                                              .port_id = DEST_PORT_ID};
+
+        DdkDataRecvInterface *ddkRecv = nullptr;
+        try {
+            ddkRecv = new DdkDataRecvInterface(this, r);
+        } catch (const std::bad_alloc& e) {
+            return HIAI_ERROR;
+        }
+        graph->SetDataRecvFunctor(target_port_config,
+            std::shared_ptr<DdkDataRecvInterface>(ddkRecv));
+        if (watchDisconnect) {
+            graph->RegisterEventHandle(hiai::HIAI_DEVICE_DISCONNECT_EVENT,
+                DeviceDisconnectCallBack);
+        }
+    }
+    return HIAI_OK;
+}
+
+void OpDispatcher::Stop()
+{
+    // let the pool finish results nobody waited for, e.g. after a timeout
+    writer.Drain();
+    // Now Stop the whole graph
+    for (auto& replica : replicas) {
+        hiai::Graph::DestroyGraph(replica.graphId);
+    }
+    activeDispatcher = nullptr;
+}
+
+bool OpDispatcher::HasFreeReplica() const
+{
+    for (auto& replica : replicas) {
+        if (replica.inFlight.size() < inFlightLimit) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t OpDispatcher::PickReplica()
+{
+    uint32_t picked = replicas.size();
+    for (uint32_t i = 0; i < replicas.size(); i++) {
+        uint32_t r = (nextReplica + i) % replicas.size();
+        if (replicas[r].inFlight.size() >= inFlightLimit) {
+            continue;
+        }
+        if (picked == replicas.size()) {
+            picked = r;
+            if (policy == DISPATCH_ROUND_ROBIN) {
+                break;
+            }
+        } else if (replicas[r].inFlight.size() < replicas[picked].inFlight.size()) {
+            picked = r;
+        }
+    }
+    nextReplica = (picked + 1) % replicas.size();
+    return picked;
+}
+
+// hash a kernel blob and drop it from the request if the replica has got it before
+void OpDispatcher::ShareKernel(uint32_t replica, CustomFileBlob& blob, uint64_t& hash, bool fullKernels)
+{
+    if (blob.data == nullptr || blob.size == 0) {
+        return;
+    }
+    hash = HashBytes(blob.data.get(), blob.size, 0);
+    std::unique_lock <std::mutex> lck(mutex);
+    if (!fullKernels && replicas[replica].kernels.count(hash) != 0) {
+        blob = {0, nullptr};
+        return;
+    }
+    replicas[replica].kernels.insert(hash);
+}
+
+// stream a blob larger than chunkSize as chunk messages of role and chain stage ahead of request
+// and leave it empty there
+int OpDispatcher::SendChunks(const std::shared_ptr<hiai::Graph>& graph, hiai::EnginePortID& engine_id,
+                             const CustomInfo& request, int32_t role, int32_t stage, uint32_t index,
+                             CustomFileBlob& blob)
+{
+    if (blob.size <= chunkSize) {
+        return SUCCESS;
+    }
+    for (uint64_t offset = 0; offset < blob.size; offset += chunkSize) {
+        std::shared_ptr<CustomInfo> chunk = make_shared<CustomInfo>();
+        chunk->requestId = request.requestId;
+        chunk->name = request.name;
+        chunk->type = request.type;
+        chunk->scratchBacking = request.scratchBacking;
+        chunk->chunkInput = index;
+        chunk->chunkRole = role;
+        chunk->chunkStage = stage;
+        chunk->chunkOffset = offset;
+        // the chunk aliases the loaded (mapped) blob, nothing is copied on the host
+        uint64_t chunkBytes = std::min(chunkSize, blob.size - offset);
+        chunk->inputList.push_back({chunkBytes, std::shared_ptr<char>(blob.data, blob.data.get() + offset)});
+        if (graph->SendData(engine_id, "string", std::static_pointer_cast<void>(chunk)) != HIAI_OK) {
+            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to send chunk %llu of stage %d %s %u of request %u.",
+                            (unsigned long long)(offset / chunkSize), stage,
+                            (role == CHUNK_EXPECT) ? "expect" : "input", index, request.requestId);
+            return FAILED;
+        }
+    }
+    blob = {0, nullptr};
+    return SUCCESS;
+}
+
+// stream inputs, chain stage inputs and expect tensors larger than chunkSize as chunk messages,
+// then send the run request
+int OpDispatcher::SendCustomInfo(uint32_t replica, uint32_t requestId, std::shared_ptr<CustomInfo> customInfo,
+                                 bool hostCompare, bool fullKernels)
+{
+    uint32_t graphId = replicas[replica].graphId;
+    std::shared_ptr<hiai::Graph> graph = hiai::Graph::GetInstance(graphId);
+    if (nullptr == graph) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to get the graph-%u.", graphId);
+        return FAILED;
+    }
+    // SourceEngine 0 port
+    hiai::EnginePortID engine_id{.graph_id = graphId, .engine_id = SRC_ENGINE_ID, .port_id = SRC_PORT_ID};
+
+    std::shared_ptr<CustomInfo> request = make_shared<CustomInfo>(*customInfo);
+    request->requestId = requestId;
+    if (hostCompare) {
+        // without expect tensors CUSTOMEngine only returns the raw outputs, all of them are needed here
+        request->expectFileList.clear();
+        request->returnOutputs = RETURN_OUTPUTS_ALWAYS;
+    }
+    ShareKernel(replica, request->binFile, request->binFileHash, fullKernels);
+    ShareKernel(replica, request->configFile, request->configFileHash, fullKernels);
+    for (auto& stage : request->chainList) {
+        ShareKernel(replica, stage.binFile, stage.binFileHash, fullKernels);
+    }
+    request->inputSizeList.clear();
+    for (uint32_t j = 0; j < request->inputList.size(); j++) {
+        request->inputSizeList.push_back(request->inputList[j].size);
+        if (SendChunks(graph, engine_id, *request, CHUNK_INPUT, 0, j, request->inputList[j]) != SUCCESS) {
+            return FAILED;
+        }
+    }
+    // side inputs of chain stages, e.g. the weights of a second conv
+    for (uint32_t s = 1; s <= request->chainList.size(); s++) {
+        ChainStage& stage = request->chainList[s - 1];
+        stage.inputSizeList.clear();
+        for (uint32_t j = 0; j < stage.inputList.size(); j++) {
+            stage.inputSizeList.push_back(stage.inputList[j].size);
+            if (SendChunks(graph, engine_id, *request, CHUNK_INPUT, s, j, stage.inputList[j]) != SUCCESS) {
+                return FAILED;
+            }
+        }
+    }
+    // expect tensors are as large as the outputs they check
+    request->expectSizeList.clear();
+    for (uint32_t j = 0; j < request->expectFileList.size(); j++) {
+        request->expectSizeList.push_back(request->expectFileList[j].size);
+        if (SendChunks(graph, engine_id, *request, CHUNK_EXPECT, 0, j, request->expectFileList[j]) != SUCCESS) {
+            return FAILED;
+        }
+    }
+    if (graph->SendData(engine_id, "string", std::static_pointer_cast<void>(request)) != HIAI_OK) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to send request %u.", requestId);
+        return FAILED;
+    }
+    return SUCCESS;
+}
+
+// take a request that never reached the replica out of flight and wake a Submit waiting for its slot,
+// false if it is not in flight any more, e.g. after Wait timed out
+bool OpDispatcher::DropInFlight(uint32_t replica, uint32_t requestId, PendingCase& pending)
+{
+    std::unique_lock <std::mutex> lck(mutex);
+    std::deque<PendingCase>& inFlight = replicas[replica].inFlight;
+    auto it = std::find_if(inFlight.begin(), inFlight.end(),
+                           [requestId](const PendingCase& entry) { return entry.requestId == requestId; });
+    if (it == inFlight.end()) {
+        return false;
+    }
+    pending = *it;
+    inFlight.erase(it);
+    cv.notify_all();
+    return true;
+}
+
+int OpDispatcher::Submit(const RunCase& runCase, bool useCache)
+{
+    if (runCase.customInfo == nullptr) {
+        return FAILED;
+    }
+    bool storeResult = useCache && resultCache != nullptr && resultCache->Mode() != CACHE_BYPASS;
+    uint64_t cacheKey = storeResult ? ResultCache::Key(*runCase.customInfo) : 0;
+    if (storeResult) {
+        std::chrono::steady_clock::time_point lookupTime = std::chrono::steady_clock::now();
+        std::shared_ptr<CustomOutput> cachedOutput = resultCache->Load(cacheKey);
+        if (cachedOutput != nullptr) {
+            HIAI_ENGINE_LOG(HIAI_IDE_INFO, "Case %u is served from the result cache.", runCase.index);
+            PendingCase pending = {0, runCase.index, runCase.outputFileList, lookupTime, cacheKey, false, nullptr,
+                                   runCase.customInfo->returnOutputs, nullptr, false, false};
+            DeliverResult(pending, cachedOutput, std::chrono::steady_clock::now(), true);
+            return SUCCESS;
+        }
+    }
+    bool hostCompare = runCase.hostCompare && !runCase.customInfo->expectFileList.empty();
+    uint32_t replica = 0;
+    uint32_t requestId = 0;
+    {
+        std::unique_lock <std::mutex> lck(mutex);
+        cv.wait(lck, [this] { return disconnected || HasFreeReplica(); });
+        if (disconnected) {
+            results[runCase.index] = CaseResult();
+            return FAILED;
+        }
+        replica = PickReplica();
+        requestId = nextRequestId++;
+        replicas[replica].inFlight.push_back({requestId, runCase.index, runCase.outputFileList,
+                                              std::chrono::steady_clock::now(), cacheKey, storeResult,
+                                              hostCompare ? runCase.customInfo : nullptr,
+                                              runCase.customInfo->returnOutputs, runCase.customInfo, hostCompare,
+                                              false});
+    }
+    if (SendCustomInfo(replica, requestId, runCase.customInfo, hostCompare, false) != SUCCESS) {
+        PendingCase pending;
+        DropInFlight(replica, requestId, pending);
+        return FAILED;
+    }
+    return SUCCESS;
+}
+
+// block until RecvData or DeviceDisconnectCallBack delivers the result
+bool OpDispatcher::Wait(uint32_t index, CaseResult& result)
+{
+    std::unique_lock <std::mutex> lck(mutex);
+    if (!cv.wait_for(lck, std::chrono::seconds(MAX_SLEEP_TIMER),
+                     [this, index] { return results.find(index) != results.end(); })) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Get output file failed. ");
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Please stop and check input and output data.");
+        // nobody waits for the case any more, free its slot so Submit does not block on it forever
+        for (auto& replica : replicas) {
+            std::deque<PendingCase>& inFlight = replica.inFlight;
+            inFlight.erase(std::remove_if(inFlight.begin(), inFlight.end(),
+                                          [index](const PendingCase& pending) { return pending.index == index; }),
+                           inFlight.end());
+        }
+        cv.notify_all();
+        return false;
+    }
+    result = results[index];
+    results.erase(index);
+    return result.valid;
+}
+
+void OpDispatcher::WriteVertifyResult(uint64_t sequence, const PendingCase& pending, const CustomOutput& customOutput)
+{
+    const std::vector<int32_t>& compareResultList = customOutput.compareResultList;
+    std::ostringstream text;
+    for (uint32_t i = 0; i < compareResultList.size() && i < pending.outputFileList.size(); i++) {
+        text << "Output file " << pending.outputFileList[i] << " compare result ";
+        text << (compareResultList[i] ? "true" : "false");
+        if (i < customOutput.compareStatsList.size()) {
+            text << ", " << CompareStatsText(customOutput.compareStatsList[i]);
+        }
+        text << "\n";
+    }
+    if (0 == compareResultList.size()) {
+        text << "None vertification result!\n";
+        text << "If you prefer to vertify output(s), please set vertify configuration.\n";
+    }
+    std::string content = text.str();
+
+    std::unique_lock <std::mutex> lck(vertifyMutex);
+    if (sequence < vertifySequence) {
+        return;  // a case delivered later has been written already
+    }
+    vertifySequence = sequence;
+    std::string vertifyResultFileName = "./output/vertifyResult.txt";
+    if (WriteFileAt(vertifyResultFileName.c_str(), content.data(), content.size(), 0, true) != SUCCESS) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to open vertifResult file %s!", vertifyResultFileName.c_str());
+    }
+}
+
+void OpDispatcher::OnResult(uint32_t replica, const std::shared_ptr<CustomOutput>& customOutput,
+                            std::chrono::steady_clock::time_point recvTime)
+{
+    PendingCase pending;
+    bool resend = false;
+    {
+        std::unique_lock <std::mutex> lck(mutex);
+        if (replica >= replicas.size() || replicas[replica].inFlight.empty()) {
+            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Replica %u has no case in flight.", replica);
+            return;
+        }
+        // an unreadable message can only be charged to the oldest request
+        std::deque<PendingCase>& inFlight = replicas[replica].inFlight;
+        auto it = inFlight.begin();
+        if (customOutput != nullptr) {
+            while (it != inFlight.end() && it->requestId != customOutput->requestId) {
+                it++;
+            }
+            if (it == inFlight.end()) {
+                HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Replica %u has no request %u in flight.", replica,
+                                customOutput->requestId);
+                return;
+            }
+        }
+        if (customOutput != nullptr && customOutput->kernelMissing) {
+            // evicted by the LRU of the engine cache, later requests must carry these blobs again
+            for (auto hash : customOutput->missingKernels) {
+                replicas[replica].kernels.erase(hash);
+            }
+        }
+        if (customOutput != nullptr && customOutput->kernelMissing && !it->resent) {
+            // CUSTOMEngine does not have a kernel sent as hash only, the request stays in flight
+            it->resent = true;
+            resend = true;
+            pending = *it;
+        } else {
+            pending = *it;
+            inFlight.erase(it);
+        }
+    }
+    if (resend) {
+        HIAI_ENGINE_LOG(HIAI_IDE_WARNING, "Replica %u misses the kernel of request %u, resend it.", replica,
+                        pending.requestId);
+        if (SendCustomInfo(replica, pending.requestId, pending.request, pending.hostCompare, true) != SUCCESS &&
+            DropInFlight(replica, pending.requestId, pending)) {
+            DeliverResult(pending, nullptr, recvTime, false);
+        }
+        return;
+    }
+    if (customOutput != nullptr && customOutput->kernelMissing) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Replica %u rejected the kernel of request %u.", replica, pending.requestId);
+        DeliverResult(pending, nullptr, recvTime, false);
+        return;
+    }
+    if (customOutput != nullptr && customOutput->failed) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Replica %u failed to run request %u.", replica, pending.requestId);
+        DeliverResult(pending, nullptr, recvTime, false);
+        return;
+    }
+    DeliverResult(pending, customOutput, recvTime, false);
+}
+
+// hand the result of one case to the writer pool, the receive callback returns at once
+void OpDispatcher::DeliverResult(const PendingCase& pending, const std::shared_ptr<CustomOutput>& customOutput,
+                                 std::chrono::steady_clock::time_point recvTime, bool cached)
+{
+    CaseResult result;
+    result.cached = cached;
+    result.latencyMs = std::chrono::duration<double, std::milli>(recvTime - pending.sendTime).count();
+    uint64_t sequence = 0;
+    {
+        std::unique_lock <std::mutex> lck(vertifyMutex);
+        sequence = nextSequence++;
+    }
+    writer.Post([this, pending, customOutput, sequence, result] {
+        PersistResult(pending, customOutput, sequence, result);
+    });
+}
+
+// compare on the host if asked, write the outputs and compare results, then wake up Wait,
+// so the files of a case are complete once Wait returns
+void OpDispatcher::PersistResult(const PendingCase& pending, const std::shared_ptr<CustomOutput>& customOutput,
+                                 uint64_t sequence, CaseResult result)
+{
+    if (customOutput != nullptr && pending.compareInfo != nullptr) {
+        CompareOutputs(*pending.compareInfo, customOutput->outputList, customOutput->compareResultList,
+                       customOutput->compareStatsList, comparePool);
+    }
+    if (customOutput == nullptr) {
+        PublishResult(pending.index, result);
+        return;
+    }
+    if (pending.outputFileList.size() != customOutput->outputList.size()) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Config output file list: %d != customOutput size: %d",
+                        pending.outputFileList.size(), customOutput->outputList.size());
+        PublishResult(pending.index, result);
+        return;
+    }
+    if (customOutput->compareResultList.size() > pending.outputFileList.size()) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "compare result size is %d, outputFileList size is %d!",
+                        customOutput->compareResultList.size(), pending.outputFileList.size());
+        PublishResult(pending.index, result);
+        return;
+    }
+    std::vector<WriteJob> jobs;
+    for (uint32_t i = 0; i < customOutput->outputList.size(); i++) {
+        const CustomFileBlob& output = customOutput->outputList[i];
+        bool passed = (i < customOutput->compareResultList.size()) && customOutput->compareResultList[i];
+        if (output.data == nullptr || pending.returnOutputs == RETURN_OUTPUTS_NEVER ||
+            (pending.returnOutputs == RETURN_OUTPUTS_ON_FAIL && passed)) {
+            continue;
+        }
+        jobs.push_back({pending.outputFileList[i], output});
+    }
+    writer.WriteFiles(jobs, [this, pending, customOutput, sequence, result](bool ok) mutable {
+        if (!ok) {
+            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Not every output of case %u was written.", pending.index);
+        }
+        WriteVertifyResult(sequence, pending, *customOutput);
+        result.valid = true;
+        result.compareResultList = customOutput->compareResultList;
+        result.compareStatsList = customOutput->compareStatsList;
+        result.opRunTime = customOutput->opRunTime;
+        result.timing = customOutput->timing;
+        // a cache entry must be able to serve any return policy, so it needs every output
+        bool complete = (pending.returnOutputs == RETURN_OUTPUTS_ALWAYS) || (pending.compareInfo != nullptr);
+        if (pending.storeResult && complete) {
+            resultCache->Store(pending.cacheKey, *customOutput);
+        }
+        PublishResult(pending.index, result);
+    });
+}
+
+void OpDispatcher::PublishResult(uint32_t index, const CaseResult& result)
+{
+    std::unique_lock <std::mutex> lck(mutex);
+    results[index] = result;
+    cv.notify_all();
+    HIAI_ENGINE_LOG(HIAI_IDE_INFO, "Receive data ok.");
+}
+
+void OpDispatcher::OnDisconnect()
+{
+    std::unique_lock <std::mutex> lck(mutex);
+    disconnected = true;
+    for (auto& replica : replicas) {
+        for (auto& pending : replica.inFlight) {
+            results[pending.index] = CaseResult();
+        }
+        replica.inFlight.clear();
+    }
+    cv.notify_all();
+}
@@ -0,0 +1,457 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#include "op_executor.h"
+#include <chrono>
+#include <sstream>
+#include <vector>
+#include "input_generator.h"
+#include "tensor_compare.h"
+
+#define CUSTOM_SUCCESS 0
+#define CUSTOM_FAILED -1
+#define RT_DEV_BINARY_MAGIC_ELF_AICPU_OPERATOR 2
+
+#define CUSTOM_RETURN_IF_ERROR(expr)  \
+do  \
+{   \
+    const int _status = (expr); \
+    if(_status != 0) \
+    { \
+        return CUSTOM_FAILED; \
+    } \
+} while(0)
+
+static double MicrosSince(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+}
+
+static std::string InputFileName(uint32_t index)
+{
+    std::stringstream ss;
+    ss << "input_"  << index;
+    return ss.str();
+}
+
+// file of a side input of chain stage s
+static std::string StageInputFileName(uint32_t stage, uint32_t index)
+{
+    std::stringstream ss;
+    ss << "stage" << stage << "_input_" << index;
+    return ss.str();
+}
+
+// scratch file a chunked input or expect tensor is reassembled in
+static std::string ChunkFileName(int32_t role, int32_t stage, uint32_t index)
+{
+    if (role == CHUNK_EXPECT) {
+        std::stringstream ss;
+        ss << "expect_"  << index;
+        return ss.str();
+    }
+    return (stage > 0) ? StageInputFileName(stage, index) : InputFileName(index);
+}
+
+// output files of one stage, stage 0 keeps the original output_j names
+static std::vector<std::string> OutputFileNames(uint32_t stage, uint32_t outputNum)
+{
+    std::vector<std::string> outFileNames;
+    for (uint32_t j = 0; j < outputNum; j++) {
+        std::stringstream ss;
+        if (stage > 0) {
+            ss << "stage" << stage << "_";
+        }
+        ss << "output_"  << j;
+        outFileNames.push_back(ss.str());
+    }
+    return outFileNames;
+}
+
+// generated inputs are expanded straight into a file if the runtime wants one, so large
+// streams never sit in memory twice
+static int32_t GenerateInput(const std::string& fileName, const InputGenerator& generator, bool toFile,
+                             int32_t backing, std::shared_ptr<OpBuffer>& buffer)
+{
+    // custom::custom_op_run takes 32-bit buffer sizes, checked before the product can wrap
+    uint32_t elemSize = GeneratorElemSize(generator.elemType);
+    if (elemSize == 0 || generator.elemNum > UINT32_MAX / elemSize) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Generated input %s of %llu elements exceeds the op run limit.",
+                        fileName.c_str(), (unsigned long long)generator.elemNum);
+        return CUSTOM_FAILED;
+    }
+    uint64_t size = generator.elemNum * elemSize;
+    if (toFile) {
+        std::unique_ptr<ScratchFile> file = ScratchFile::Create(fileName, backing);
+        if (file == nullptr || WriteGeneratedInput(file->Path().c_str(), generator) != CUSTOM_SUCCESS) {
+            return CUSTOM_FAILED;
+        }
+        buffer = OpBuffer::FromFile(std::move(file), size);
+        return CUSTOM_SUCCESS;
+    }
+    std::shared_ptr< char > dataPtr(new char[ size ], [](char* p) {
+        delete[] p;
+    });
+    if (GenerateElements(generator, 0, generator.elemNum, dataPtr.get()) != CUSTOM_SUCCESS) {
+        return CUSTOM_FAILED;
+    }
+    buffer = std::make_shared<OpBuffer>(fileName, CustomFileBlob{size, dataPtr});
+    return CUSTOM_SUCCESS;
+}
+
+int32_t OpExecutor::StageInputChunk(const CustomInfo& chunk)
+{
+    if (chunk.inputList.size() != 1) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Chunk message should carry one blob, but carries %d.",
+                        chunk.inputList.size());
+        return CUSTOM_FAILED;
+    }
+    const CustomFileBlob& blob = chunk.inputList[0];
+    StageKey key(chunk.requestId, chunk.chunkRole, chunk.chunkStage, chunk.chunkInput);
+    std::string fileName = ChunkFileName(chunk.chunkRole, chunk.chunkStage, chunk.chunkInput);
+    std::string path;
+    {
+        // chunks of one input may be handled by several threads in any order, the first creates the file
+        std::unique_lock <std::mutex> lck(stageMutex);
+        StagedInput& staged = stagedInputs[key];
+        if (staged.file == nullptr) {
+            staged.file = ScratchFile::Create(fileName, chunk.scratchBacking);
+        }
+        if (staged.file == nullptr) {
+            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "No %s scratch file for chunk of %s.",
+                            ScratchBackingName(chunk.scratchBacking), fileName.c_str());
+            staged.failed = true;
+            stageCv.notify_all();
+            return CUSTOM_FAILED;
+        }
+        path = staged.file->Path();
+    }
+    int32_t ret = WriteFileAt(path.c_str(), blob.data.get(), blob.size, chunk.chunkOffset, false);
+    std::unique_lock <std::mutex> lck(stageMutex);
+    StagedInput& staged = stagedInputs[key];
+    if (ret != CUSTOM_SUCCESS) {
+        staged.failed = true;
+    } else {
+        staged.bytes += blob.size;
+    }
+    stageCv.notify_all();
+    return ret;
+}
+
+std::shared_ptr<OpBuffer> OpExecutor::TakeStagedInput(const StageKey& key, uint64_t size)
+{
+    std::unique_lock <std::mutex> lck(stageMutex);
+    stageCv.wait_for(lck, std::chrono::seconds(STAGE_WAIT_SECONDS), [this, &key, size] {
+        auto it = stagedInputs.find(key);
+        return it != stagedInputs.end() && (it->second.failed || it->second.bytes >= size);
+    });
+    auto it = stagedInputs.find(key);
+    if (it == stagedInputs.end() || it->second.failed || it->second.bytes != size) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "%s expects %llu bytes, but %llu bytes were staged.",
+                        ChunkFileName(std::get<1>(key), std::get<2>(key), std::get<3>(key)).c_str(),
+                        (unsigned long long)size,
+                        (unsigned long long)((it == stagedInputs.end()) ? 0 : it->second.bytes));
+        return nullptr;
+    }
+    std::shared_ptr<OpBuffer> buffer = OpBuffer::FromFile(std::move(it->second.file), size);
+    stagedInputs.erase(it);
+    return buffer;
+}
+
+void OpExecutor::DropStagedInputs(uint32_t requestId)
+{
+    std::unique_lock <std::mutex> lck(stageMutex);
+    auto it = stagedInputs.lower_bound(StageKey(requestId, INT32_MIN, INT32_MIN, INT32_MIN));
+    while (it != stagedInputs.end() && std::get<0>(it->first) == requestId) {
+        it = stagedInputs.erase(it);
+    }
+}
+
+std::shared_ptr<OpBuffer> OpExecutor::ResolveKernelBlob(const CustomFileBlob& blob, uint64_t hash,
+                                                        const std::string& name, int32_t backing)
+{
+    if (hash == 0) {
+        // a host that does not share kernels, stage the blob for this request only
+        return std::make_shared<OpBuffer>(name, blob);
+    }
+    if (blob.data != nullptr) {
+        return kernelCache.Put(hash, blob, runtime->NeedsFiles(), backing);
+    }
+    return kernelCache.Get(hash);
+}
+
+// operands stay in memory unless the runtime works on files
+int32_t OpExecutor::PrepareInputs(const CustomInfo& customInfo, std::vector<std::shared_ptr<OpBuffer> >& inputs)
+{
+    for (uint32_t j = 0; j < customInfo.inputList.size(); j++) {
+        std::string inFileName = InputFileName(j);
+        if (j < customInfo.inputGeneratorList.size() && customInfo.inputGeneratorList[j].distribution != GEN_NONE) {
+            std::shared_ptr<OpBuffer> input;
+            CUSTOM_RETURN_IF_ERROR(GenerateInput(inFileName, customInfo.inputGeneratorList[j], runtime->NeedsFiles(),
+                                                 customInfo.scratchBacking, input));
+            inputs.push_back(input);
+            continue;
+        }
+        uint64_t inputSize = (j < customInfo.inputSizeList.size()) ? customInfo.inputSizeList[j] : 0;
+        if (customInfo.inputList[j].size == 0 && inputSize > 0) {
+            // already reassembled from chunk messages
+            std::shared_ptr<OpBuffer> input = TakeStagedInput(StageKey(customInfo.requestId, CHUNK_INPUT, 0, j),
+                                                              inputSize);
+            if (input == nullptr) {
+                return CUSTOM_FAILED;
+            }
+            inputs.push_back(input);
+            continue;
+        }
+        inputs.push_back(std::make_shared<OpBuffer>(inFileName, customInfo.inputList[j]));
+    }
+    return CUSTOM_SUCCESS;
+}
+
+// side inputs of chain stages 1..n, sent whole or in chunks like the inputs of the request;
+// stageInputs[s][j] stays nullptr where the input is an output of stage s - 1
+int32_t OpExecutor::PrepareStageInputs(const CustomInfo& customInfo,
+                                       std::vector< std::vector< std::shared_ptr<OpBuffer> > >& stageInputs)
+{
+    for (uint32_t s = 1; s <= customInfo.chainList.size(); s++) {
+        const ChainStage& stage = customInfo.chainList[s - 1];
+        stageInputs[s].assign(stage.inputLinkList.size(), nullptr);
+        for (uint32_t j = 0; j < stage.inputLinkList.size(); j++) {
+            if (stage.inputLinkList[j] >= 0) {
+                continue;
+            }
+            if (j >= stage.inputList.size()) {
+                HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Stage %u input %u has no output or file to read.", s, j);
+                return CUSTOM_FAILED;
+            }
+            uint64_t inputSize = (j < stage.inputSizeList.size()) ? stage.inputSizeList[j] : 0;
+            if (stage.inputList[j].size == 0 && inputSize > 0) {
+                stageInputs[s][j] = TakeStagedInput(StageKey(customInfo.requestId, CHUNK_INPUT, s, j), inputSize);
+                if (stageInputs[s][j] == nullptr) {
+                    return CUSTOM_FAILED;
+                }
+                continue;
+            }
+            stageInputs[s][j] = std::make_shared<OpBuffer>(StageInputFileName(s, j), stage.inputList[j]);
+        }
+    }
+    return CUSTOM_SUCCESS;
+}
+
+// expect tensors sent whole are used as they are, chunked ones are read back once from their scratch file
+int32_t OpExecutor::PrepareExpects(const CustomInfo& customInfo, std::vector<CustomFileBlob>& expects)
+{
+    for (uint32_t j = 0; j < customInfo.expectFileList.size(); j++) {
+        uint64_t expectSize = (j < customInfo.expectSizeList.size()) ? customInfo.expectSizeList[j] : 0;
+        if (customInfo.expectFileList[j].size == 0 && expectSize > 0) {
+            std::shared_ptr<OpBuffer> expect = TakeStagedInput(StageKey(customInfo.requestId, CHUNK_EXPECT, 0, j),
+                                                               expectSize);
+            CustomFileBlob blob = {0, nullptr};
+            if (expect == nullptr || expect->Memory(blob) != CUSTOM_SUCCESS) {
+                return CUSTOM_FAILED;
+            }
+            expects.push_back(blob);
+            continue;
+        }
+        expects.push_back(customInfo.expectFileList[j]);
+    }
+    return CUSTOM_SUCCESS;
+}
+
+// compared in memory, the output is read once for the readback too
+int32_t OpExecutor::CompareOutput(const CustomInfo& customInfo, uint32_t i, const CustomFileBlob& expectBlob,
+                                  const CustomFileBlob& outputBlob, bool& compareRet, CompareStats& stats)
+{
+    if (i >= customInfo.dataTypeList.size()) {
+        return CUSTOM_FAILED;
+    }
+    return CompareTensor(expectBlob, outputBlob, customInfo.dataTypeList[i],
+                         customInfo.precisionDeviation, customInfo.statisticalDiscrepancy, compareRet, stats);
+}
+
+// one run of a kernel, the timing of file staging goes to the stages it belongs to
+int32_t OpExecutor::RunKernel(const OpKernel& kernel, const std::vector<std::shared_ptr<OpBuffer> >& inputs,
+                              const std::vector<std::string>& outputNames, const std::vector<uint64_t>& outputSizes,
+                              std::vector<std::shared_ptr<OpBuffer> >& outputs, double& opRunTime,
+                              StageTiming& timing)
+{
+    if (runtime->NeedsFiles()) {
+        // staged here rather than inside Run, so the time is not mistaken for the kernel's
+        std::string path;
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        for (auto& input : inputs) {
+            CUSTOM_RETURN_IF_ERROR(input->File(path, kernel.scratchBacking));
+        }
+        timing.inputStaging += MicrosSince(begin);
+        begin = std::chrono::steady_clock::now();
+        if (kernel.binFile != nullptr) {
+            CUSTOM_RETURN_IF_ERROR(kernel.binFile->File(path, kernel.scratchBacking));
+        }
+        if (kernel.type == RT_DEV_BINARY_MAGIC_ELF_AICPU_OPERATOR && kernel.configFile != nullptr) {
+            CUSTOM_RETURN_IF_ERROR(kernel.configFile->File(path, kernel.scratchBacking));
+        }
+        timing.binaryStaging += MicrosSince(begin);
+    }
+    return runtime->Run(kernel, inputs, outputNames, outputSizes, outputs, opRunTime);
+}
+
+int32_t OpExecutor::Execute(const CustomInfo& customInfo, CustomOutput& customOutput)
+{
+    customOutput.requestId = customInfo.requestId;
+    customOutput.timing.deserialize = customInfo.deserializeTime;
+
+    // every kernel of the request, the config file is shared by the chain
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    int32_t backing = customInfo.scratchBacking;
+    std::shared_ptr<OpBuffer> configFile = ResolveKernelBlob(customInfo.configFile, customInfo.configFileHash,
+                                                             "configFile", backing);
+    std::vector< OpKernel > kernels;
+    kernels.push_back({customInfo.name, customInfo.type,
+                       ResolveKernelBlob(customInfo.binFile, customInfo.binFileHash,
+                                         "tvm_op_run_temp_file_bin_file.o", backing), configFile,
+                       customInfo.workspaceSizeList, backing});
+    for (uint32_t s = 1; s <= customInfo.chainList.size(); s++) {
+        const ChainStage& stage = customInfo.chainList[s - 1];
+        std::stringstream ss;
+        ss << "stage" << s << "_bin_file.o";
+        kernels.push_back({stage.name, stage.type,
+                           ResolveKernelBlob(stage.binFile, stage.binFileHash, ss.str(), backing), configFile,
+                           stage.workspaceSizeList, backing});
+    }
+    customOutput.timing.binaryStaging = MicrosSince(begin);
+    // inputs and expect tensors first, so chunks of this request never outlive it even if it is resent
+    begin = std::chrono::steady_clock::now();
+    std::vector< std::vector< std::shared_ptr<OpBuffer> > > stageInputs(1 + customInfo.chainList.size());
+    std::vector<CustomFileBlob> expects;
+    if (PrepareInputs(customInfo, stageInputs[0]) != CUSTOM_SUCCESS ||
+        PrepareStageInputs(customInfo, stageInputs) != CUSTOM_SUCCESS ||
+        PrepareExpects(customInfo, expects) != CUSTOM_SUCCESS) {
+        DropStagedInputs(customInfo.requestId);
+        return CUSTOM_FAILED;
+    }
+    customOutput.timing.inputStaging = MicrosSince(begin);
+    // dropped from the cache or sent to another engine, the host forgets the hashes and resends the blobs
+    if (kernels[0].configFile == nullptr) {
+        customOutput.missingKernels.push_back(customInfo.configFileHash);
+    }
+    for (uint32_t s = 0; s < kernels.size(); s++) {
+        if (kernels[s].binFile == nullptr) {
+            customOutput.missingKernels.push_back((s == 0) ? customInfo.binFileHash :
+                                                  customInfo.chainList[s - 1].binFileHash);
+        }
+    }
+    if (!customOutput.missingKernels.empty()) {
+        HIAI_ENGINE_LOG(HIAI_IDE_WARNING, "Kernel of request %u is not cached.", customInfo.requestId);
+        customOutput.kernelMissing = true;
+        return CUSTOM_SUCCESS;
+    }
+
+    // outputs of every stage, kept until the taps are read back
+    std::vector< std::vector< std::shared_ptr<OpBuffer> > > stageOutputs(1 + customInfo.chainList.size());
+    CUSTOM_RETURN_IF_ERROR(RunKernel(kernels[0], stageInputs[0], OutputFileNames(0, customInfo.outputSizeList.size()),
+                                     customInfo.outputSizeList, stageOutputs[0], customOutput.opRunTime,
+                                     customOutput.timing));
+
+    // chain mode: the outputs of a stage are handed to the next one as they are,
+    // nothing goes back to the host in between
+    for (uint32_t s = 1; s <= customInfo.chainList.size(); s++) {
+        const ChainStage& stage = customInfo.chainList[s - 1];
+        const std::vector< std::shared_ptr<OpBuffer> >& prevOutputs = stageOutputs[s - 1];
+        for (uint32_t j = 0; j < stage.inputLinkList.size(); j++) {
+            int32_t link = stage.inputLinkList[j];
+            if (link < 0) {
+                continue;
+            }
+            if ((uint32_t)link >= prevOutputs.size()) {
+                HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Stage %u input %u has no output or file to read.", s, j);
+                return CUSTOM_FAILED;
+            }
+            stageInputs[s][j] = prevOutputs[link];
+        }
+        double stageRunTime = 0;
+        CUSTOM_RETURN_IF_ERROR(RunKernel(kernels[s], stageInputs[s], OutputFileNames(s, stage.outputSizeList.size()),
+                                         stage.outputSizeList, stageOutputs[s], stageRunTime, customOutput.timing));
+        customOutput.opRunTime += stageRunTime;
+    }
+    const std::vector< std::shared_ptr<OpBuffer> >& outputs = stageOutputs.back();
+
+    uint32_t compareNum = customInfo.expectFileList.size();
+    if (compareNum != 0 && outputs.size() != compareNum) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Expect output file number: %d != actual output file number: %d.",
+                        compareNum, outputs.size());
+        return CUSTOM_FAILED;
+    }
+    // final outputs first, tapped chain outputs after them
+    std::vector<OpBuffer*> returned;
+    for (auto& output : outputs) {
+        returned.push_back(output.get());
+    }
+    for (auto& tap : customInfo.tapList) {
+        if (tap.stage < 0 || (uint32_t)tap.stage >= stageOutputs.size() || tap.output < 0 ||
+            (uint32_t)tap.output >= stageOutputs[tap.stage].size()) {
+            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Tap of stage %d output %d does not exist.", tap.stage, tap.output);
+            return CUSTOM_FAILED;
+        }
+        returned.push_back(stageOutputs[tap.stage][tap.output].get());
+    }
+    customOutput.compareResultList.assign(compareNum, false);
+    customOutput.compareStatsList.assign(compareNum, CompareStats());
+    customOutput.outputList.assign(returned.size(), CustomFileBlob{0, nullptr});
+
+    // read what is compared or returned, then compare; the host only gets what it asked for
+    std::vector<double> readbackTimes(returned.size(), 0);
+    std::vector<double> compareTimes(returned.size(), 0);
+    auto finishOne = [this, &customInfo, &customOutput, &returned, &outputs, &expects, compareNum, &readbackTimes,
+                      &compareTimes](uint32_t j) {
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        CustomFileBlob blob = {0, nullptr};
+        int32_t readRet = CUSTOM_FAILED;
+        if (j < compareNum || customInfo.returnOutputs != RETURN_OUTPUTS_NEVER) {
+            readRet = returned[j]->Memory(blob, &outputArena);
+        }
+        readbackTimes[j] = MicrosSince(begin);
+        bool passed = false;
+        if (j < compareNum) {
+            begin = std::chrono::steady_clock::now();
+            CompareStats& stats = customOutput.compareStatsList[j];
+            if (readRet != CUSTOM_SUCCESS ||
+                CompareOutput(customInfo, j, expects[j], blob, passed, stats) != CUSTOM_SUCCESS) {
+                passed = false;
+            } else {
+                customOutput.compareResultList[j] = passed;
+                HIAI_ENGINE_LOG(HIAI_IDE_INFO, "Compare result of output %u: %s, %s.", j, passed ? "true" : "false",
+                                CompareStatsText(stats).c_str());
+            }
+            compareTimes[j] = MicrosSince(begin);
+        }
+        // taps were only read if they are returned at all
+        bool wanted = (j >= outputs.size()) || customInfo.returnOutputs == RETURN_OUTPUTS_ALWAYS ||
+                      (customInfo.returnOutputs == RETURN_OUTPUTS_ON_FAIL && !passed);
+        if (readRet == CUSTOM_SUCCESS && wanted) {
+            customOutput.outputList[j] = blob;
+        }
+    };
+    // large outputs go to the readback pool, so the file read of one output overlaps the
+    // compare of another; small ones are not worth waking threads for
+    uint64_t returnedBytes = 0;
+    for (auto buffer : returned) {
+        returnedBytes += buffer->Size();
+    }
+    if (returnedBytes >= PARALLEL_READBACK_BYTES) {
+        readbackPool.ParallelFor(returned.size(), finishOne);
+    } else {
+        for (uint32_t j = 0; j < returned.size(); j++) {
+            finishOne(j);
+        }
+    }
+    for (uint32_t j = 0; j < returned.size(); j++) {
+        customOutput.timing.readback += readbackTimes[j];
+        customOutput.timing.compare += compareTimes[j];
+    }
+    return CUSTOM_SUCCESS;
+}
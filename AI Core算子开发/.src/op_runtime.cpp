@@ -0,0 +1,79 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#include "op_runtime.h"
+#include <fstream>
+
+#define CUSTOM_SUCCESS 0
+#define CUSTOM_FAILED -1
+
+OpBuffer::OpBuffer(const std::string& name, const CustomFileBlob& blob)
+    : name(name), size(blob.size), memory(blob)
+{
+}
+
+std::shared_ptr<OpBuffer> OpBuffer::FromFile(std::unique_ptr<ScratchFile> file, uint64_t size)
+{
+    std::shared_ptr<OpBuffer> buffer(new OpBuffer("", {size, nullptr}));
+    buffer->file = std::move(file);
+    return buffer;
+}
+
+int32_t OpBuffer::Memory(CustomFileBlob& blob, BufferPool* pool)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (memory.data == nullptr && file != nullptr) {
+        std::ifstream in(file->Path(), std::ios::binary | std::ios::ate);
+        if (!in.is_open()) {
+            return CUSTOM_FAILED;
+        }
+        uint64_t length = in.tellg();
+        in.seekg(0, std::ios::beg);
+        // overwritten by the read right away, so never cleared
+        shared_ptr< char > dataPtr = (pool != nullptr) ? pool->Acquire(length) : nullptr;
+        if (dataPtr == nullptr) {
+            dataPtr.reset(new char[ length ], [](char* p) {
+                delete[] p;
+            });
+        }
+        if (!in.read(dataPtr.get(), length)) {
+            return CUSTOM_FAILED;
+        }
+        in.close();
+        memory = {length, dataPtr};
+        size = length;
+    }
+    blob = memory;
+    return CUSTOM_SUCCESS;
+}
+
+int32_t OpBuffer::File(std::string& path, int32_t backing)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file == nullptr) {
+        std::unique_ptr<ScratchFile> scratch = ScratchFile::Create(name, backing);
+        if (scratch == nullptr) {
+            HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Failed to create %s scratch file %s.", ScratchBackingName(backing),
+                            name.c_str());
+            return CUSTOM_FAILED;
+        }
+        if (WriteFileAt(scratch->Path().c_str(), memory.data.get(), memory.size, 0, true) != CUSTOM_SUCCESS) {
+            return CUSTOM_FAILED;
+        }
+        file = std::move(scratch);
+    }
+    path = file->Path();
+    return CUSTOM_SUCCESS;
+}
+
+void OpBuffer::SetMemory(const CustomFileBlob& blob)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    memory = blob;
+    size = blob.size;
+}
@@ -0,0 +1,303 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#include "op_sweep.h"
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include "host_standin.h"
+#include "op_dispatcher.h"
+#include "test_spec.h"
+
+#define SUCCESS 0
+#define FAILED -1
+#define RT_DEV_BINARY_MAGIC_ELF_AICPU_OPERATOR 2
+
+static const char* REDUCTION_FLOPS_OPS[] = {"ASUM", "SUMSQ"};  // one more op per element than SUM and MEAN
+
+// one shape of the sweep with its cost model and measurements
+struct SweepPoint
+{
+    std::vector<int64_t> shape;
+    std::string shapeKey;  // dims joined with '_'
+    std::vector<uint64_t> inputElems;
+    uint64_t outputElems = 0;
+    double flops = 0;
+    uint64_t bytes = 0;  // every input read once, the output written once
+    bool valid = false;
+    std::vector<double> kernelMs;   // op_run time on the device, stand-in time on the host
+    std::vector<double> end2endMs;  // send to receive, equal to kernelMs on the host
+};
+
+static std::string ShapeKey(const std::vector<int64_t>& shape, char separator)
+{
+    std::string key;
+    for (size_t d = 0; d < shape.size(); d++) {
+        key += (d == 0 ? "" : std::string(1, separator)) + std::to_string(shape[d]);
+    }
+    return key;
+}
+
+static std::string Substitute(std::string pattern, const std::string& shapeKey)
+{
+    const std::string placeholder = "{shape}";
+    for (size_t pos = pattern.find(placeholder); pos != std::string::npos; pos = pattern.find(placeholder, pos)) {
+        pattern.replace(pos, placeholder.length(), shapeKey);
+        pos += shapeKey.length();
+    }
+    return pattern;
+}
+
+static void ModelShape(const SweepSpec& spec, SweepPoint& point)
+{
+    if (spec.kernel == SWEEP_CONV) {
+        ConvShape conv = MakeConvShape(point.shape);
+        point.inputElems = {(uint64_t)(conv.n * conv.cin * conv.h * conv.w),
+                            (uint64_t)(conv.cout * conv.cin * conv.kh * conv.kw)};
+        point.outputElems = (uint64_t)(conv.n * conv.cout * conv.OutH() * conv.OutW());
+        point.flops = 2.0 * point.outputElems * conv.cin * conv.kh * conv.kw;
+    } else {
+        int32_t axis = (spec.axis < 0) ? spec.axis + (int32_t)point.shape.size() : spec.axis;
+        uint64_t outer = 1;
+        uint64_t inner = 1;
+        for (int32_t d = 0; d < (int32_t)point.shape.size(); d++) {
+            (d < axis ? outer : inner) *= (uint64_t)point.shape[d];
+        }
+        point.inputElems = {outer * inner};
+        point.outputElems = outer;
+        // scale by coeff and accumulate, ASUM and SUMSQ add abs or square
+        double opsPerElem = 2;
+        for (auto op : REDUCTION_FLOPS_OPS) {
+            opsPerElem += (spec.op == op) ? 1 : 0;
+        }
+        point.flops = opsPerElem * outer * inner;
+    }
+    point.bytes = point.outputElems * spec.elemSize;
+    for (auto elems : point.inputElems) {
+        point.bytes += elems * spec.elemSize;
+    }
+}
+
+static InputGenerator InputOf(const SweepSpec& spec, const SweepPoint& point, uint32_t i)
+{
+    InputGenerator generator = spec.generator;
+    generator.elemNum = point.inputElems[i];
+    generator.seed = spec.generator.seed + i;  // weights differ from the feature map
+    return generator;
+}
+
+static int RunOnDevice(const SweepSpec& spec, OpDispatcher& dispatcher, const std::string& configFile,
+                       int32_t scratchBacking, uint32_t& nextIndex, SweepPoint& point)
+{
+    RunCase runCase;
+    runCase.customInfo = std::make_shared<CustomInfo>();
+    CustomInfo& customInfo = *runCase.customInfo;
+    customInfo.name = Substitute(spec.kernelName, point.shapeKey);
+    customInfo.type = spec.type;
+    std::string binFile = Substitute(spec.binFile, point.shapeKey);
+    if (LoadFileBlob(binFile.c_str(), customInfo.binFile) != SUCCESS) {
+        fprintf(stdout, "[Error] Load bin file %s failed.\n", binFile.c_str());
+        return FAILED;
+    }
+    if (spec.type == RT_DEV_BINARY_MAGIC_ELF_AICPU_OPERATOR &&
+        LoadFileBlob(configFile.c_str(), customInfo.configFile) != SUCCESS) {
+        fprintf(stdout, "[Error] Load config file %s failed.\n", configFile.c_str());
+        return FAILED;
+    }
+    // inputs are expanded on the device and outputs stay there, only timings come back
+    for (uint32_t i = 0; i < point.inputElems.size(); i++) {
+        customInfo.inputList.push_back({0, nullptr});
+        customInfo.inputGeneratorList.push_back(InputOf(spec, point, i));
+    }
+    customInfo.outputSizeList = {point.outputElems * spec.elemSize};
+    customInfo.returnOutputs = RETURN_OUTPUTS_NEVER;
+    customInfo.scratchBacking = scratchBacking;
+    runCase.outputFileList = {""};
+
+    for (uint32_t run = 0; run < spec.warmup + spec.repeat; run++) {
+        CaseResult result;
+        runCase.index = nextIndex++;
+        if (dispatcher.Submit(runCase, false) != SUCCESS || !dispatcher.Wait(runCase.index, result) ||
+            !result.valid) {
+            fprintf(stdout, "[Error] Sweep shape %s run %u failed.\n", point.shapeKey.c_str(), run);
+            return FAILED;
+        }
+        if (run >= spec.warmup) {
+            point.kernelMs.push_back(result.opRunTime / 1000);
+            point.end2endMs.push_back(result.latencyMs);
+        }
+    }
+    return SUCCESS;
+}
+
+static int RunOnHost(const SweepSpec& spec, SweepPoint& point)
+{
+    std::vector<std::unique_ptr<char[]> > inputs;
+    for (uint32_t i = 0; i < point.inputElems.size(); i++) {
+        inputs.emplace_back(new char[point.inputElems[i] * spec.elemSize + 1]);
+        if (GenerateElements(InputOf(spec, point, i), 0, point.inputElems[i], inputs[i].get()) != SUCCESS) {
+            return FAILED;
+        }
+    }
+    std::unique_ptr<char[]> output(new char[point.outputElems * spec.elemSize + 1]);
+    for (uint32_t run = 0; run < spec.warmup + spec.repeat; run++) {
+        auto start = std::chrono::steady_clock::now();
+        int32_t ret = (spec.kernel == SWEEP_CONV) ?
+                      HostConv2d(MakeConvShape(point.shape), spec.generator.elemType, inputs[0].get(),
+                                 inputs[1].get(), output.get()) :
+                      HostReduction(point.shape, spec.axis, spec.op, spec.coeff, spec.generator.elemType,
+                                    inputs[0].get(), output.get());
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (ret != SUCCESS) {
+            fprintf(stdout, "[Error] Host stand-in failed on shape %s.\n", point.shapeKey.c_str());
+            return FAILED;
+        }
+        if (run >= spec.warmup) {
+            point.kernelMs.push_back(ms);
+            point.end2endMs.push_back(ms);
+        }
+    }
+    return SUCCESS;
+}
+
+static double Median(std::vector<double> samples)
+{
+    if (samples.empty()) {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+// derived columns of one report row, achieved rates at the median kernel time
+struct Roofline
+{
+    double minMs = 0;
+    double p50Ms = 0;
+    double end2endMs = 0;
+    double intensity = 0;   // FLOP per byte
+    double gbps = 0;
+    double gflops = 0;
+    double attainable = 0;  // GFLOP/s the roofline allows at this intensity, 0 without peaks
+    double fraction = 0;
+    const char* bound = "";
+};
+
+static Roofline Evaluate(const SweepSpec& spec, const SweepPoint& point)
+{
+    Roofline row;
+    if (point.valid) {
+        row.minMs = *std::min_element(point.kernelMs.begin(), point.kernelMs.end());
+        row.p50Ms = Median(point.kernelMs);
+        row.end2endMs = Median(point.end2endMs);
+    }
+    row.intensity = (point.bytes > 0) ? point.flops / point.bytes : 0;
+    if (row.p50Ms > 0) {
+        row.gbps = point.bytes / (row.p50Ms * 1e6);
+        row.gflops = point.flops / (row.p50Ms * 1e6);
+    }
+    double memoryRoof = row.intensity * spec.peakGBps;
+    if (spec.peakGflops > 0 && (spec.peakGBps <= 0 || spec.peakGflops <= memoryRoof)) {
+        row.attainable = spec.peakGflops;
+        row.bound = "compute";
+    } else if (spec.peakGBps > 0) {
+        row.attainable = memoryRoof;
+        row.bound = "memory";
+    }
+    row.fraction = (row.attainable > 0) ? row.gflops / row.attainable : 0;
+    return row;
+}
+
+static int WriteReport(const SweepSpec& spec, bool onHost, const std::vector<SweepPoint>& points)
+{
+    std::string csvName = spec.report + ".csv";
+    std::string jsonName = spec.report + ".json";
+    FILE* csv = fopen(csvName.c_str(), "w");
+    FILE* json = fopen(jsonName.c_str(), "w");
+    if (csv == NULL || json == NULL) {
+        fprintf(stdout, "[Error] Open sweep report %s failed.\n", spec.report.c_str());
+        if (csv != NULL) {
+            fclose(csv);
+        }
+        if (json != NULL) {
+            fclose(json);
+        }
+        return FAILED;
+    }
+    const char* kernel = (spec.kernel == SWEEP_CONV) ? "conv" : "reduction";
+    const char* op = (spec.kernel == SWEEP_CONV) ? "" : spec.op.c_str();
+    fprintf(csv, "kernel,shape,dtype,op,status,runs,min_ms,p50_ms,end2end_p50_ms,bytes,flops,"
+            "intensity,gbps,gflops,attainable_gflops,peak_fraction,bound\n");
+    fprintf(json, "{\n  \"kernel\": \"%s\",\n  \"runtime\": \"%s\",\n  \"dtype\": \"%s\",\n  \"op\": \"%s\",\n"
+            "  \"peakGflops\": %g,\n  \"peakGBps\": %g,\n  \"points\": [", kernel, onHost ? "host" : "device",
+            spec.dtype.c_str(), op, spec.peakGflops, spec.peakGBps);
+    for (size_t i = 0; i < points.size(); i++) {
+        const SweepPoint& point = points[i];
+        Roofline row = Evaluate(spec, point);
+        std::string shape = ShapeKey(point.shape, 'x');
+        fprintf(csv, "%s,%s,%s,%s,%s,%zu,%.6f,%.6f,%.6f,%llu,%.0f,%.4f,%.3f,%.3f,%.3f,%.4f,%s\n", kernel,
+                shape.c_str(), spec.dtype.c_str(), op, point.valid ? "ok" : "failed", point.kernelMs.size(),
+                row.minMs, row.p50Ms, row.end2endMs, (unsigned long long)point.bytes, point.flops, row.intensity,
+                row.gbps, row.gflops, row.attainable, row.fraction, row.bound);
+        fprintf(json, "%s\n    {\"shape\": [%s], \"status\": \"%s\", \"runs\": %zu, \"minMs\": %.6f, "
+                "\"p50Ms\": %.6f, \"end2endP50Ms\": %.6f, \"bytes\": %llu, \"flops\": %.0f, \"intensity\": %.4f, "
+                "\"gbps\": %.3f, \"gflops\": %.3f, \"attainableGflops\": %.3f, \"peakFraction\": %.4f, "
+                "\"bound\": \"%s\"}", (i == 0) ? "" : ",", ShapeKey(point.shape, ',').c_str(),
+                point.valid ? "ok" : "failed", point.kernelMs.size(), row.minMs, row.p50Ms, row.end2endMs,
+                (unsigned long long)point.bytes, point.flops, row.intensity, row.gbps, row.gflops,
+                row.attainable, row.fraction, row.bound);
+    }
+    fprintf(json, "\n  ]\n}\n");
+    bool failed = (ferror(csv) != 0) || (ferror(json) != 0);
+    failed = (fclose(csv) != 0) || failed;
+    failed = (fclose(json) != 0) || failed;
+    if (failed) {
+        fprintf(stdout, "[Error] Write sweep report %s failed.\n", spec.report.c_str());
+        return FAILED;
+    }
+    fprintf(stdout, "Sweep report: %s, %s\n", csvName.c_str(), jsonName.c_str());
+    return SUCCESS;
+}
+
+int RunSweep(const std::string& specFile, OpDispatcher* dispatcher, const std::string& configFile,
+             int32_t scratchBacking)
+{
+    SweepSpec spec;
+    if (LoadSweepSpec(specFile, spec, stdout) != SUCCESS) {
+        return FAILED;
+    }
+    fprintf(stdout, "Sweep %s: %zu shapes, warmup %u, repeat %u on the %s\n", specFile.c_str(), spec.shapes.size(),
+            spec.warmup, spec.repeat, (dispatcher == nullptr) ? "host stand-in" : "device");
+    std::vector<SweepPoint> points;
+    uint32_t nextIndex = 0;
+    int sweepResult = SUCCESS;
+    for (auto& shape : spec.shapes) {
+        SweepPoint point;
+        point.shape = shape;
+        point.shapeKey = ShapeKey(shape, '_');
+        ModelShape(spec, point);
+        int ret = (dispatcher == nullptr) ? RunOnHost(spec, point) :
+                  RunOnDevice(spec, *dispatcher, configFile, scratchBacking, nextIndex, point);
+        point.valid = (ret == SUCCESS);
+        sweepResult = point.valid ? sweepResult : FAILED;
+        points.push_back(point);
+
+        Roofline row = Evaluate(spec, point);
+        fprintf(stdout, "Shape %s %s p50 %.3f ms, %.3f GB/s, %.3f GFLOP/s", point.shapeKey.c_str(),
+                point.valid ? "ok" : "failed", row.p50Ms, row.gbps, row.gflops);
+        if (point.valid && row.attainable > 0) {
+            fprintf(stdout, ", %.1f%% of %s peak", row.fraction * 100, row.bound);
+        }
+        fprintf(stdout, "\n");
+    }
+    if (WriteReport(spec, dispatcher == nullptr, points) != SUCCESS) {
+        return FAILED;
+    }
+    return sweepResult;
+}
@@ -0,0 +1,102 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#include "output_writer.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#define SUCCESS 0
+#define FAILED -1
+
+OutputWriter::OutputWriter(uint32_t threadNum)
+{
+    for (uint32_t i = 0; i < std::max(threadNum, 1u); i++) {
+        workers.push_back(std::thread(&OutputWriter::WorkerLoop, this));
+    }
+}
+
+OutputWriter::~OutputWriter()
+{
+    {
+        std::unique_lock <std::mutex> lck(mutex);
+        stopping = true;
+    }
+    taskCv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void OutputWriter::Post(std::function<void()> task)
+{
+    {
+        std::unique_lock <std::mutex> lck(mutex);
+        tasks.push_back(std::move(task));
+    }
+    taskCv.notify_one();
+}
+
+void OutputWriter::WriteFiles(const std::vector<WriteJob>& jobs, std::function<void(bool ok)> done)
+{
+    if (jobs.empty()) {
+        Post([done] { done(true); });
+        return;
+    }
+    // shared by the jobs of this batch, the last one to finish calls done
+    struct Batch
+    {
+        std::atomic<uint32_t> remaining;
+        std::atomic<bool> ok;
+        std::function<void(bool)> done;
+    };
+    std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+    batch->remaining = jobs.size();
+    batch->ok = true;
+    batch->done = std::move(done);
+    for (auto& job : jobs) {
+        Post([batch, job] {
+            if (WriteFileAt(job.fileName.c_str(), job.data.data.get(), job.data.size, 0, true) != SUCCESS) {
+                HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Write output file %s failed!", job.fileName.c_str());
+                batch->ok = false;
+            } else {
+                HIAI_ENGINE_LOG(HIAI_IDE_INFO, "Write output file success! %s", job.fileName.c_str());
+            }
+            if (--batch->remaining == 0) {
+                batch->done(batch->ok);
+            }
+        });
+    }
+}
+
+void OutputWriter::Drain()
+{
+    std::unique_lock <std::mutex> lck(mutex);
+    idleCv.wait(lck, [this] { return tasks.empty() && running == 0; });
+}
+
+void OutputWriter::WorkerLoop()
+{
+    std::unique_lock <std::mutex> lck(mutex);
+    while (true) {
+        taskCv.wait(lck, [this] { return stopping || !tasks.empty(); });
+        if (tasks.empty()) {
+            return;  // stopping and nothing left
+        }
+        std::function<void()> task = std::move(tasks.front());
+        tasks.pop_front();
+        running++;
+        lck.unlock();
+        task();
+        lck.lock();
+        running--;
+        if (tasks.empty() && running == 0) {
+            idleCv.notify_all();
+        }
+    }
+}
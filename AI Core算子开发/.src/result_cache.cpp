@@ -0,0 +1,234 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#include "result_cache.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "../common/op_attr.h"
+
+static const uint32_t CACHE_MAGIC = 0x4352504f;  // "OPRC"
+static const uint32_t CACHE_VERSION = 3;
+
+static uint64_t HashBlob(const CustomFileBlob& blob, uint64_t seed)
+{
+    return HashBytes(blob.data.get(), blob.data.get() == nullptr ? 0 : blob.size, seed);
+}
+
+template<class T>
+static uint64_t HashValue(const T& value, uint64_t seed)
+{
+    return HashBytes(reinterpret_cast<const char*>(&value), sizeof(T), seed);
+}
+
+ResultCache::ResultCache(const std::string& cacheDir, CacheMode mode) : cacheDir(cacheDir), mode(mode)
+{
+    if (mode != CACHE_BYPASS && mkdir(cacheDir.c_str(), 0755) != 0 && errno != EEXIST) {
+        HIAI_ENGINE_LOG(HIAI_IDE_WARNING, "Failed to create cache dir %s, cache disabled.", cacheDir.c_str());
+        this->mode = CACHE_BYPASS;
+    }
+}
+
+uint64_t ResultCache::Key(const CustomInfo& customInfo)
+{
+    uint64_t key = HashValue(CACHE_VERSION, 0);
+    key = HashBytes(customInfo.name.data(), customInfo.name.size(), key);
+    key = HashValue(customInfo.type, key);
+    key = HashBlob(customInfo.binFile, key);
+    key = HashBlob(customInfo.configFile, key);
+    for (auto& input : customInfo.inputList) {
+        key = HashBlob(input, key);
+    }
+    for (auto& generator : customInfo.inputGeneratorList) {
+        key = HashValue(generator.distribution, key);
+        key = HashValue(generator.elemType, key);
+        key = HashValue(generator.elemNum, key);
+        key = HashValue(generator.seed, key);
+        key = HashValue(generator.param0, key);
+        key = HashValue(generator.param1, key);
+    }
+    for (auto outputSize : customInfo.outputSizeList) {
+        key = HashValue(outputSize, key);
+    }
+    // custom_op_run gets the workspace sizes, a kernel may behave differently with other ones
+    for (auto workspaceSize : customInfo.workspaceSizeList) {
+        key = HashValue(workspaceSize, key);
+    }
+    for (auto& stage : customInfo.chainList) {
+        key = HashBytes(stage.name.data(), stage.name.size(), key);
+        key = HashValue(stage.type, key);
+        key = HashBlob(stage.binFile, key);
+        for (auto outputSize : stage.outputSizeList) {
+            key = HashValue(outputSize, key);
+        }
+        for (auto link : stage.inputLinkList) {
+            key = HashValue(link, key);
+        }
+        for (auto& input : stage.inputList) {
+            key = HashBlob(input, key);
+        }
+        for (auto workspaceSize : stage.workspaceSizeList) {
+            key = HashValue(workspaceSize, key);
+        }
+    }
+    for (auto& tap : customInfo.tapList) {
+        key = HashValue(tap.stage, key);
+        key = HashValue(tap.output, key);
+    }
+
+    // CUSTOMEngine fills OpAttr with the same setOpParam
+    OpAttr opAttr;
+    memset(&opAttr, 0, sizeof(opAttr));
+    setOpParam(&opAttr);
+    key = HashValue(opAttr, key);
+
+    // the stored compare results are only valid for the same golden data and tolerances
+    for (auto dataType : customInfo.dataTypeList) {
+        key = HashValue(dataType, key);
+    }
+    key = HashValue(customInfo.precisionDeviation, key);
+    key = HashValue(customInfo.statisticalDiscrepancy, key);
+    for (auto& expect : customInfo.expectFileList) {
+        key = HashBlob(expect, key);
+    }
+    return key;
+}
+
+std::string ResultCache::FileName(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.bin", (unsigned long long)key);
+    return cacheDir + name;
+}
+
+std::shared_ptr<CustomOutput> ResultCache::Load(uint64_t key)
+{
+    if (mode != CACHE_USE) {
+        return nullptr;
+    }
+    std::string fileName = FileName(key);
+    struct stat fileStat;
+    CustomFileBlob blob;
+    if (stat(fileName.c_str(), &fileStat) != 0 || LoadFileBlob(fileName.c_str(), blob) != 0) {
+        return nullptr;
+    }
+
+    // layout: magic, version, output count, {size, bytes}..., compare count, results..., op run time,
+    // stats count, {elemNum, deviated, maxAbsError, maxRelError, ulp count, ulps..., index count, indices...}...
+    const char* p = blob.data.get();
+    const char* end = p + blob.size;
+    auto take = [&p, end](void* out, uint64_t size) {
+        if ((uint64_t)(end - p) < size) {
+            return false;
+        }
+        memcpy(out, p, size);
+        p += size;
+        return true;
+    };
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t outputNum = 0;
+    if (!take(&magic, sizeof(magic)) || !take(&version, sizeof(version)) || magic != CACHE_MAGIC ||
+        version != CACHE_VERSION || !take(&outputNum, sizeof(outputNum))) {
+        HIAI_ENGINE_LOG(HIAI_IDE_WARNING, "Ignore broken cache file %s.", fileName.c_str());
+        return nullptr;
+    }
+    std::shared_ptr<CustomOutput> customOutput = std::make_shared<CustomOutput>();
+    for (uint32_t i = 0; i < outputNum; i++) {
+        uint64_t size = 0;
+        if (!take(&size, sizeof(size)) || (uint64_t)(end - p) < size) {
+            return nullptr;
+        }
+        // outputs alias the mapped cache file
+        customOutput->outputList.push_back({size, std::shared_ptr<char>(blob.data, const_cast<char*>(p))});
+        p += size;
+    }
+    uint32_t compareNum = 0;
+    if (!take(&compareNum, sizeof(compareNum))) {
+        return nullptr;
+    }
+    customOutput->compareResultList.resize(compareNum);
+    if (!take(customOutput->compareResultList.data(), compareNum * sizeof(int32_t)) ||
+        !take(&customOutput->opRunTime, sizeof(customOutput->opRunTime))) {
+        return nullptr;
+    }
+    auto takeList = [&take, end, &p](std::vector<uint64_t>& list) {
+        uint32_t num = 0;
+        if (!take(&num, sizeof(num)) || (uint64_t)(end - p) / sizeof(uint64_t) < num) {
+            return false;
+        }
+        list.resize(num);
+        return take(list.data(), num * sizeof(uint64_t));
+    };
+    uint32_t statsNum = 0;
+    if (!take(&statsNum, sizeof(statsNum)) || statsNum > compareNum) {
+        return nullptr;
+    }
+    customOutput->compareStatsList.resize(statsNum);
+    for (auto& stats : customOutput->compareStatsList) {
+        if (!take(&stats.elemNum, sizeof(stats.elemNum)) || !take(&stats.deviated, sizeof(stats.deviated)) ||
+            !take(&stats.maxAbsError, sizeof(stats.maxAbsError)) ||
+            !take(&stats.maxRelError, sizeof(stats.maxRelError)) || !takeList(stats.ulpHistogram) ||
+            !takeList(stats.firstMismatches)) {
+            return nullptr;
+        }
+    }
+    return customOutput;
+}
+
+void ResultCache::Store(uint64_t key, const CustomOutput& customOutput)
+{
+    if (mode == CACHE_BYPASS) {
+        return;
+    }
+    // write a temp file and rename it, readers never see a partial entry
+    std::string fileName = FileName(key);
+    std::ostringstream tempName;
+    tempName << fileName << ".tmp." << std::this_thread::get_id();
+    std::ofstream file(tempName.str(), std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file.is_open()) {
+        HIAI_ENGINE_LOG(HIAI_IDE_WARNING, "Failed to write cache file %s.", tempName.str().c_str());
+        return;
+    }
+    uint32_t outputNum = customOutput.outputList.size();
+    uint32_t compareNum = customOutput.compareResultList.size();
+    file.write(reinterpret_cast<const char*>(&CACHE_MAGIC), sizeof(CACHE_MAGIC));
+    file.write(reinterpret_cast<const char*>(&CACHE_VERSION), sizeof(CACHE_VERSION));
+    file.write(reinterpret_cast<const char*>(&outputNum), sizeof(outputNum));
+    for (auto& output : customOutput.outputList) {
+        file.write(reinterpret_cast<const char*>(&output.size), sizeof(output.size));
+        file.write(output.data.get(), output.size);
+    }
+    file.write(reinterpret_cast<const char*>(&compareNum), sizeof(compareNum));
+    file.write(reinterpret_cast<const char*>(customOutput.compareResultList.data()), compareNum * sizeof(int32_t));
+    file.write(reinterpret_cast<const char*>(&customOutput.opRunTime), sizeof(customOutput.opRunTime));
+    auto writeList = [&file](const std::vector<uint64_t>& list) {
+        uint32_t num = list.size();
+        file.write(reinterpret_cast<const char*>(&num), sizeof(num));
+        file.write(reinterpret_cast<const char*>(list.data()), num * sizeof(uint64_t));
+    };
+    uint32_t statsNum = customOutput.compareStatsList.size();
+    file.write(reinterpret_cast<const char*>(&statsNum), sizeof(statsNum));
+    for (auto& stats : customOutput.compareStatsList) {
+        file.write(reinterpret_cast<const char*>(&stats.elemNum), sizeof(stats.elemNum));
+        file.write(reinterpret_cast<const char*>(&stats.deviated), sizeof(stats.deviated));
+        file.write(reinterpret_cast<const char*>(&stats.maxAbsError), sizeof(stats.maxAbsError));
+        file.write(reinterpret_cast<const char*>(&stats.maxRelError), sizeof(stats.maxRelError));
+        writeList(stats.ulpHistogram);
+        writeList(stats.firstMismatches);
+    }
+    file.close();
+    if (file.fail() || rename(tempName.str().c_str(), fileName.c_str()) != 0) {
+        HIAI_ENGINE_LOG(HIAI_IDE_WARNING, "Failed to store cache file %s.", fileName.c_str());
+        remove(tempName.str().c_str());
+    }
+}
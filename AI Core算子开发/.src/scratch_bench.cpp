@@ -0,0 +1,171 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+// Times the scratch file round trip of CUSTOMEngine on every backing: create, write the
+// blob, read it back and remove it, for blobs of 4 KiB up to maxMiB. Run it on the board,
+// the spread between p50 and max is the page cache writeback jitter kernels see.
+//   ./scratch_bench [maxMiB(1024)] [repeat(0 = by size)]
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "scratch_file.h"
+
+#define SUCCESS 0
+#define FAILED -1
+
+static const uint64_t MIN_BLOB_BYTES = 4 * 1024;
+static const uint64_t READ_BLOCK_BYTES = 64 * 1024 * 1024;
+static const uint64_t AUTO_REPEAT_BYTES = 1024ULL * 1024 * 1024;  // about this much traffic per size
+
+struct RoundTrip
+{
+    double writeUs;
+    double readUs;
+    double removeUs;
+};
+
+static int WriteAll(const char* path, const char* data, uint64_t size)
+{
+    int fd = open(path, O_WRONLY | O_TRUNC);
+    if (fd < 0) {
+        return FAILED;
+    }
+    uint64_t written = 0;
+    while (written < size) {
+        ssize_t ret = pwrite(fd, data + written, size - written, written);
+        if (ret <= 0) {
+            close(fd);
+            return FAILED;
+        }
+        written += ret;
+    }
+    close(fd);
+    return SUCCESS;
+}
+
+static int ReadAll(const char* path, char* block, uint64_t size)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return FAILED;
+    }
+    uint64_t done = 0;
+    while (done < size) {
+        ssize_t ret = pread(fd, block, std::min(READ_BLOCK_BYTES, size - done), done);
+        if (ret <= 0) {
+            close(fd);
+            return FAILED;
+        }
+        done += ret;
+    }
+    close(fd);
+    return SUCCESS;
+}
+
+static double Since(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+}
+
+static int RunOnce(int32_t backing, const char* data, char* block, uint64_t size, RoundTrip& trip)
+{
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    std::unique_ptr<ScratchFile> file = ScratchFile::Create("scratch_bench", backing);
+    if (file == nullptr || WriteAll(file->Path().c_str(), data, size) != SUCCESS) {
+        return FAILED;
+    }
+    trip.writeUs = Since(begin);
+    begin = std::chrono::steady_clock::now();
+    if (ReadAll(file->Path().c_str(), block, size) != SUCCESS) {
+        return FAILED;
+    }
+    trip.readUs = Since(begin);
+    begin = std::chrono::steady_clock::now();
+    file.reset();
+    trip.removeUs = Since(begin);
+    return SUCCESS;
+}
+
+static double Percentile(std::vector<double> values, double fraction)
+{
+    std::sort(values.begin(), values.end());
+    return values[(size_t)(fraction * (values.size() - 1))];
+}
+
+static std::string SizeName(uint64_t size)
+{
+    char name[32];
+    if (size >= 1024 * 1024 * 1024) {
+        snprintf(name, sizeof(name), "%lluG", (unsigned long long)(size >> 30));
+    } else if (size >= 1024 * 1024) {
+        snprintf(name, sizeof(name), "%lluM", (unsigned long long)(size >> 20));
+    } else {
+        snprintf(name, sizeof(name), "%lluK", (unsigned long long)(size >> 10));
+    }
+    return name;
+}
+
+int main(int argc, char* argv[])
+{
+    uint64_t maxBytes = ((argc > 1) ? strtoull(argv[1], NULL, 10) : 1024) * 1024 * 1024;
+    uint32_t repeat = (argc > 2) ? strtoul(argv[2], NULL, 10) : 0;
+    if (argc > 3 || maxBytes < MIN_BLOB_BYTES) {
+        fprintf(stderr, "Usage: %s [maxMiB(1024)] [repeat(0 = by size)]\n", argv[0]);
+        return FAILED;
+    }
+    std::unique_ptr<char[]> data(new char[maxBytes]);
+    std::unique_ptr<char[]> block(new char[std::min(READ_BLOCK_BYTES, maxBytes)]);
+    for (uint64_t i = 0; i < maxBytes; i++) {
+        data[i] = (char)(i * 131);  // touch every page before timing
+    }
+
+    fprintf(stdout, "%-7s %-6s %6s %12s %12s %12s %12s %12s %10s\n", "backing", "size", "runs", "write p50",
+            "read p50", "total p50", "total p99", "total max", "GB/s");
+    const int32_t backings[] = {SCRATCH_DISK, SCRATCH_TMPFS, SCRATCH_MEMFD};
+    for (int32_t backing : backings) {
+        for (uint64_t size = MIN_BLOB_BYTES; size <= maxBytes; size *= 4) {
+            uint32_t runs = repeat;
+            if (runs == 0) {
+                runs = std::max<uint64_t>(5, std::min<uint64_t>(200, AUTO_REPEAT_BYTES / size));
+            }
+            std::vector<double> writeUs;
+            std::vector<double> readUs;
+            std::vector<double> totalUs;
+            RoundTrip trip;
+            bool failed = false;
+            for (uint32_t run = 0; run < runs; run++) {
+                if (RunOnce(backing, data.get(), block.get(), size, trip) != SUCCESS) {
+                    failed = true;
+                    break;
+                }
+                writeUs.push_back(trip.writeUs);
+                readUs.push_back(trip.readUs);
+                totalUs.push_back(trip.writeUs + trip.readUs + trip.removeUs);
+            }
+            if (failed) {
+                fprintf(stdout, "%-7s %-6s unavailable: %s\n", ScratchBackingName(backing), SizeName(size).c_str(),
+                        strerror(errno));
+                break;
+            }
+            double p50 = Percentile(totalUs, 0.5);
+            fprintf(stdout, "%-7s %-6s %6u %10.1fus %10.1fus %10.1fus %10.1fus %10.1fus %10.3f\n",
+                    ScratchBackingName(backing), SizeName(size).c_str(), runs, Percentile(writeUs, 0.5),
+                    Percentile(readUs, 0.5), p50, Percentile(totalUs, 0.99), Percentile(totalUs, 1.0),
+                    2.0 * size / (p50 * 1000.0));
+        }
+    }
+    return SUCCESS;
+}
@@ -0,0 +1,99 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#include "scratch_file.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <atomic>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+static std::atomic<uint64_t> g_scratchSequence(0);
+
+int32_t ParseScratchBacking(const std::string& name)
+{
+    if (name == "disk") {
+        return SCRATCH_DISK;
+    } else if (name == "tmpfs") {
+        return SCRATCH_TMPFS;
+    } else if (name == "memfd") {
+        return SCRATCH_MEMFD;
+    }
+    return -1;
+}
+
+const char* ScratchBackingName(int32_t backing)
+{
+    switch (backing) {
+        case SCRATCH_DISK: return "disk";
+        case SCRATCH_TMPFS: return "tmpfs";
+        case SCRATCH_MEMFD: return "memfd";
+        default: return "unknown";
+    }
+}
+
+// glibc only wraps memfd_create from 2.27 on, the device toolchain is older
+static int MemfdCreate(const char* name)
+{
+#ifdef SYS_memfd_create
+    return syscall(SYS_memfd_create, name, MFD_CLOEXEC);
+#else
+    (void)name;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+std::unique_ptr<ScratchFile> ScratchFile::Create(const std::string& name, int32_t backing)
+{
+    if (backing == SCRATCH_MEMFD) {
+        int fd = MemfdCreate(name.c_str());
+        if (fd < 0) {
+            return nullptr;
+        }
+        // the DDK reopens the path, which reaches the same memory
+        char path[32];
+        snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+        return std::unique_ptr<ScratchFile>(new ScratchFile(path, fd));
+    }
+    // unique across engine threads, replicas and processes sharing the directory
+    char unique[48];
+    snprintf(unique, sizeof(unique), "op%d_%llu_", (int)getpid(), (unsigned long long)g_scratchSequence++);
+    std::string path;
+    if (backing == SCRATCH_TMPFS) {
+        if (mkdir(SCRATCH_TMPFS_DIR, 0700) != 0 && errno != EEXIST) {
+            return nullptr;
+        }
+        path = SCRATCH_TMPFS_DIR + (unique + name);
+    } else if (backing == SCRATCH_DISK) {
+        path = SCRATCH_DISK_DIR + (unique + name);
+    } else {
+        return nullptr;
+    }
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return nullptr;
+    }
+    close(fd);
+    return std::unique_ptr<ScratchFile>(new ScratchFile(path, -1));
+}
+
+ScratchFile::~ScratchFile()
+{
+    if (fd >= 0) {
+        close(fd);
+    } else {
+        remove(path.c_str());
+    }
+}
@@ -0,0 +1,493 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#include "tensor_compare.h"
+#include <string.h>
+#include <cmath>
+#include <sstream>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COMPARE_AVX2
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define COMPARE_NEON
+#endif
+
+#define SUCCESS 0
+#define FAILED -1
+
+// lower bound of every ULP bucket after bucket 0
+static const uint32_t ULP_BOUNDS[COMPARE_ULP_BUCKETS - 1] = {1, 2, 4, 16, 256, 65536};
+
+static uint32_t ElemSize(int32_t dataType)
+{
+    switch (dataType) {
+        case COMPARE_FP32:
+        case COMPARE_INT32:
+            return sizeof(uint32_t);
+        case COMPARE_FP16:
+        case COMPARE_BF16:
+            return sizeof(uint16_t);
+        case COMPARE_INT8:
+            return sizeof(int8_t);
+        default:
+            return 0;
+    }
+}
+
+static uint32_t UlpBucket(uint64_t ulp)
+{
+    uint32_t bucket = 0;
+    while (bucket < COMPARE_ULP_BUCKETS - 1 && ulp >= ULP_BOUNDS[bucket]) {
+        bucket++;
+    }
+    return bucket;
+}
+
+// float bits as integers in value order, neighbouring values are 1 apart and -0 == +0
+static int64_t OrderedKey(uint32_t bits, uint32_t signBit)
+{
+    int64_t magnitude = bits & (signBit - 1);
+    return (bits & signBit) ? -magnitude : magnitude;
+}
+
+static void AddMismatch(CompareStats& stats, uint64_t index)
+{
+    stats.deviated++;
+    if (stats.firstMismatches.size() < COMPARE_MISMATCH_NUM) {
+        stats.firstMismatches.push_back(index);
+    }
+}
+
+// T is float for the float types and int8, double for int32 which float can not hold
+template<typename T>
+static void CompareElement(CompareStats& stats, uint64_t index, T expect, T output, int64_t expectKey,
+                           int64_t outputKey, T precisionDeviation)
+{
+    if (std::isnan(expect) || std::isnan(output)) {
+        if (std::isnan(expect) && std::isnan(output)) {
+            stats.ulpHistogram[0]++;
+        } else {
+            AddMismatch(stats, index);
+            stats.ulpHistogram[COMPARE_ULP_BUCKETS - 1]++;
+        }
+        return;
+    }
+    if (expect == output) {
+        stats.ulpHistogram[0]++;  // covers equal infinities
+        return;
+    }
+    // any error bound of an infinite expect is inf or NaN, so test infinities by themselves
+    if (std::isinf(expect) || std::isinf(output)) {
+        AddMismatch(stats, index);
+        stats.ulpHistogram[COMPARE_ULP_BUCKETS - 1]++;
+        return;
+    }
+    T absError = std::fabs(output - expect);
+    if (absError > precisionDeviation * std::fabs(expect)) {
+        AddMismatch(stats, index);
+    }
+    T relError = absError / std::fabs(expect);
+    if (absError > stats.maxAbsError) {
+        stats.maxAbsError = absError;
+    }
+    if (relError > stats.maxRelError) {
+        stats.maxRelError = relError;
+    }
+    uint64_t ulp = (outputKey > expectKey) ? (outputKey - expectKey) : (expectKey - outputKey);
+    stats.ulpHistogram[UlpBucket(ulp)]++;
+}
+
+// elements [begin, end) one by one, the reference the vector paths have to match
+static void CompareRange(const char* e, const char* o, uint64_t begin, uint64_t end, int32_t dataType,
+                         float precisionDeviation, CompareStats& stats)
+{
+    for (uint64_t i = begin; i < end; i++) {
+        if (dataType == COMPARE_FP32) {
+            uint32_t expectBits = 0;
+            uint32_t outputBits = 0;
+            float expectValue = 0;
+            float outputValue = 0;
+            memcpy(&expectBits, e + i * sizeof(float), sizeof(float));
+            memcpy(&outputBits, o + i * sizeof(float), sizeof(float));
+            memcpy(&expectValue, &expectBits, sizeof(float));
+            memcpy(&outputValue, &outputBits, sizeof(float));
+            CompareElement<float>(stats, i, expectValue, outputValue, OrderedKey(expectBits, 0x80000000U),
+                                  OrderedKey(outputBits, 0x80000000U), precisionDeviation);
+        } else if (dataType == COMPARE_FP16 || dataType == COMPARE_BF16) {
+            uint16_t expectBits = 0;
+            uint16_t outputBits = 0;
+            memcpy(&expectBits, e + i * sizeof(uint16_t), sizeof(uint16_t));
+            memcpy(&outputBits, o + i * sizeof(uint16_t), sizeof(uint16_t));
+            float expectValue = 0;
+            float outputValue = 0;
+            if (dataType == COMPARE_FP16) {
+                expectValue = HalfToFloat(expectBits);
+                outputValue = HalfToFloat(outputBits);
+            } else {
+                // bfloat16 is the upper half of a float
+                uint32_t bits = (uint32_t)expectBits << 16;
+                memcpy(&expectValue, &bits, sizeof(float));
+                bits = (uint32_t)outputBits << 16;
+                memcpy(&outputValue, &bits, sizeof(float));
+            }
+            CompareElement<float>(stats, i, expectValue, outputValue, OrderedKey(expectBits, 0x8000),
+                                  OrderedKey(outputBits, 0x8000), precisionDeviation);
+        } else if (dataType == COMPARE_INT8) {
+            int8_t expectValue = (int8_t)e[i];
+            int8_t outputValue = (int8_t)o[i];
+            CompareElement<float>(stats, i, expectValue, outputValue, expectValue, outputValue, precisionDeviation);
+        } else {
+            int32_t expectValue = 0;
+            int32_t outputValue = 0;
+            memcpy(&expectValue, e + i * sizeof(int32_t), sizeof(int32_t));
+            memcpy(&outputValue, o + i * sizeof(int32_t), sizeof(int32_t));
+            CompareElement<double>(stats, i, expectValue, outputValue, expectValue, outputValue, precisionDeviation);
+        }
+    }
+}
+
+// Vector paths: full blocks of lanes in order. A block holding a NaN or an unequal infinity,
+// or an int32 block that is not bit equal, goes through CompareRange; lane counters of the
+// ULP buckets are folded into stats at the end. Both return the number of elements done, the tail is left over.
+#ifdef COMPARE_AVX2
+// bits of each lane as an OrderedKey, signBit sits at bit 31 of sign
+__attribute__((target("avx2,f16c")))
+static __m256i OrderedKeys(__m256i bits, __m256i magnitudeMask, __m256i sign)
+{
+    return _mm256_sign_epi32(_mm256_and_si256(bits, magnitudeMask), sign);
+}
+
+__attribute__((target("avx2,f16c")))
+static __m256 LoadLanes(const char* p, int32_t dataType, __m256i& keys)
+{
+    if (dataType == COMPARE_FP32) {
+        __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        keys = OrderedKeys(bits, _mm256_set1_epi32(0x7fffffff), bits);
+        return _mm256_castsi256_ps(bits);
+    }
+    if (dataType == COMPARE_INT8) {
+        __m256i values = _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+        keys = values;
+        return _mm256_cvtepi32_ps(values);
+    }
+    __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m256i bits = _mm256_cvtepu16_epi32(half);
+    keys = OrderedKeys(bits, _mm256_set1_epi32(0x7fff), _mm256_slli_epi32(bits, 16));
+    if (dataType == COMPARE_FP16) {
+        return _mm256_cvtph_ps(half);
+    }
+    return _mm256_castsi256_ps(_mm256_slli_epi32(bits, 16));
+}
+
+__attribute__((target("avx2,f16c")))
+static uint64_t CompareAvx2(const char* e, const char* o, uint64_t elemNum, int32_t dataType,
+                            float precisionDeviation, CompareStats& stats)
+{
+    const uint32_t lanes = 8;
+    const uint32_t elemSize = ElemSize(dataType);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 deviation = _mm256_set1_ps(precisionDeviation);
+    const __m256 inf = _mm256_set1_ps(INFINITY);
+    __m256 maxAbs = _mm256_setzero_ps();
+    __m256 maxRel = _mm256_setzero_ps();
+    __m256i bounds[COMPARE_ULP_BUCKETS - 1];
+    __m256i atLeast[COMPARE_ULP_BUCKETS - 1];  // per lane, elements at or over each bound
+    for (uint32_t b = 0; b < COMPARE_ULP_BUCKETS - 1; b++) {
+        bounds[b] = _mm256_set1_epi32(ULP_BOUNDS[b]);
+        atLeast[b] = _mm256_setzero_si256();
+    }
+    uint64_t vectorNum = 0;
+    uint64_t blockEnd = elemNum - elemNum % lanes;
+    for (uint64_t i = 0; i < blockEnd; i += lanes) {
+        const char* eBlock = e + i * elemSize;
+        const char* oBlock = o + i * elemSize;
+        if (dataType == COMPARE_INT32) {
+            __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(eBlock)),
+                                               _mm256_loadu_si256(reinterpret_cast<const __m256i*>(oBlock)));
+            if (_mm256_movemask_epi8(equal) != -1) {
+                CompareRange(e, o, i, i + lanes, dataType, precisionDeviation, stats);
+            } else {
+                vectorNum += lanes;
+            }
+            continue;
+        }
+        __m256i eKeys;
+        __m256i oKeys;
+        __m256 eValues = LoadLanes(eBlock, dataType, eKeys);
+        __m256 oValues = LoadLanes(oBlock, dataType, oKeys);
+        __m256 nan = _mm256_or_ps(_mm256_cmp_ps(eValues, eValues, _CMP_UNORD_Q),
+                                  _mm256_cmp_ps(oValues, oValues, _CMP_UNORD_Q));
+        __m256 equal = _mm256_cmp_ps(eValues, oValues, _CMP_EQ_OQ);
+        __m256 absExpect = _mm256_and_ps(eValues, absMask);
+        __m256 infinite = _mm256_or_ps(_mm256_cmp_ps(absExpect, inf, _CMP_EQ_OQ),
+                                       _mm256_cmp_ps(_mm256_and_ps(oValues, absMask), inf, _CMP_EQ_OQ));
+        if (_mm256_movemask_ps(_mm256_or_ps(nan, _mm256_andnot_ps(equal, infinite))) != 0) {
+            CompareRange(e, o, i, i + lanes, dataType, precisionDeviation, stats);
+            continue;
+        }
+        __m256 absError = _mm256_and_ps(_mm256_sub_ps(oValues, eValues), absMask);
+        __m256 deviates = _mm256_andnot_ps(equal, _mm256_cmp_ps(absError, _mm256_mul_ps(deviation, absExpect),
+                                                                _CMP_GT_OQ));
+        int32_t mask = _mm256_movemask_ps(deviates);
+        for (uint32_t lane = 0; mask != 0 && lane < lanes; lane++) {
+            if (mask & (1 << lane)) {
+                AddMismatch(stats, i + lane);
+            }
+        }
+        // equal lanes count as 0, the other lanes are finite here
+        maxAbs = _mm256_max_ps(_mm256_andnot_ps(equal, absError), maxAbs);
+        maxRel = _mm256_max_ps(_mm256_andnot_ps(equal, _mm256_div_ps(absError, absExpect)), maxRel);
+        // the key distance always fits in 32 bits unsigned
+        __m256i ulp = _mm256_sub_epi32(_mm256_max_epi32(eKeys, oKeys), _mm256_min_epi32(eKeys, oKeys));
+        for (uint32_t b = 0; b < COMPARE_ULP_BUCKETS - 1; b++) {
+            __m256i over = _mm256_cmpeq_epi32(_mm256_max_epu32(ulp, bounds[b]), ulp);
+            atLeast[b] = _mm256_sub_epi32(atLeast[b], over);
+        }
+        vectorNum += lanes;
+    }
+
+    float absLanes[8];
+    float relLanes[8];
+    _mm256_storeu_ps(absLanes, maxAbs);
+    _mm256_storeu_ps(relLanes, maxRel);
+    for (uint32_t lane = 0; lane < lanes; lane++) {
+        if (absLanes[lane] > stats.maxAbsError) {
+            stats.maxAbsError = absLanes[lane];
+        }
+        if (relLanes[lane] > stats.maxRelError) {
+            stats.maxRelError = relLanes[lane];
+        }
+    }
+    uint64_t atLeastNum[COMPARE_ULP_BUCKETS - 1] = {0};
+    for (uint32_t b = 0; b < COMPARE_ULP_BUCKETS - 1; b++) {
+        uint32_t counts[8];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(counts), atLeast[b]);
+        for (uint32_t lane = 0; lane < lanes; lane++) {
+            atLeastNum[b] += counts[lane];
+        }
+    }
+    stats.ulpHistogram[0] += vectorNum - atLeastNum[0];
+    for (uint32_t b = 1; b < COMPARE_ULP_BUCKETS - 1; b++) {
+        stats.ulpHistogram[b] += atLeastNum[b - 1] - atLeastNum[b];
+    }
+    stats.ulpHistogram[COMPARE_ULP_BUCKETS - 1] += atLeastNum[COMPARE_ULP_BUCKETS - 2];
+    return blockEnd;
+}
+#endif
+
+#ifdef COMPARE_NEON
+static int32x4_t OrderedKeys(uint32x4_t bits, uint32_t signBit)
+{
+    int32x4_t magnitude = vreinterpretq_s32_u32(vandq_u32(bits, vdupq_n_u32(signBit - 1)));
+    return vbslq_s32(vtstq_u32(bits, vdupq_n_u32(signBit)), vnegq_s32(magnitude), magnitude);
+}
+
+static float32x4_t LoadLanes(const char* p, int32_t dataType, int32x4_t& keys)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(p);
+    if (dataType == COMPARE_FP32) {
+        uint32x4_t bits = vreinterpretq_u32_u8(vld1q_u8(bytes));
+        keys = OrderedKeys(bits, 0x80000000U);
+        return vreinterpretq_f32_u32(bits);
+    }
+    if (dataType == COMPARE_INT8) {
+        int32_t word = 0;
+        memcpy(&word, p, sizeof(word));
+        int32x4_t values = vmovl_s16(vget_low_s16(vmovl_s8(vreinterpret_s8_s32(vdup_n_s32(word)))));
+        keys = values;
+        return vcvtq_f32_s32(values);
+    }
+    uint16x4_t half = vreinterpret_u16_u8(vld1_u8(bytes));
+    uint32x4_t bits = vmovl_u16(half);
+    keys = OrderedKeys(bits, 0x8000);
+    if (dataType == COMPARE_FP16) {
+        return vcvt_f32_f16(vreinterpret_f16_u16(half));
+    }
+    return vreinterpretq_f32_u32(vshlq_n_u32(bits, 16));
+}
+
+static uint64_t CompareNeon(const char* e, const char* o, uint64_t elemNum, int32_t dataType,
+                            float precisionDeviation, CompareStats& stats)
+{
+    const uint32_t lanes = 4;
+    const uint32_t elemSize = ElemSize(dataType);
+    const float32x4_t deviation = vdupq_n_f32(precisionDeviation);
+    const float32x4_t inf = vdupq_n_f32(INFINITY);
+    float32x4_t maxAbs = vdupq_n_f32(0);
+    float32x4_t maxRel = vdupq_n_f32(0);
+    uint32x4_t bounds[COMPARE_ULP_BUCKETS - 1];
+    uint32x4_t atLeast[COMPARE_ULP_BUCKETS - 1];  // per lane, elements at or over each bound
+    for (uint32_t b = 0; b < COMPARE_ULP_BUCKETS - 1; b++) {
+        bounds[b] = vdupq_n_u32(ULP_BOUNDS[b]);
+        atLeast[b] = vdupq_n_u32(0);
+    }
+    uint64_t vectorNum = 0;
+    uint64_t blockEnd = elemNum - elemNum % lanes;
+    for (uint64_t i = 0; i < blockEnd; i += lanes) {
+        if (dataType == COMPARE_INT32) {
+            const uint8_t* eBlock = reinterpret_cast<const uint8_t*>(e + i * elemSize);
+            const uint8_t* oBlock = reinterpret_cast<const uint8_t*>(o + i * elemSize);
+            uint32x4_t equal = vceqq_u32(vreinterpretq_u32_u8(vld1q_u8(eBlock)),
+                                         vreinterpretq_u32_u8(vld1q_u8(oBlock)));
+            if (vminvq_u32(equal) == 0) {
+                CompareRange(e, o, i, i + lanes, dataType, precisionDeviation, stats);
+            } else {
+                vectorNum += lanes;
+            }
+            continue;
+        }
+        int32x4_t eKeys;
+        int32x4_t oKeys;
+        float32x4_t eValues = LoadLanes(e + i * elemSize, dataType, eKeys);
+        float32x4_t oValues = LoadLanes(o + i * elemSize, dataType, oKeys);
+        uint32x4_t equal = vceqq_f32(eValues, oValues);
+        float32x4_t absExpect = vabsq_f32(eValues);
+        uint32x4_t infinite = vorrq_u32(vceqq_f32(absExpect, inf), vceqq_f32(vabsq_f32(oValues), inf));
+        if (vminvq_u32(vandq_u32(vceqq_f32(eValues, eValues), vceqq_f32(oValues, oValues))) == 0 ||
+            vmaxvq_u32(vbicq_u32(infinite, equal)) != 0) {
+            CompareRange(e, o, i, i + lanes, dataType, precisionDeviation, stats);
+            continue;
+        }
+        float32x4_t absError = vabsq_f32(vsubq_f32(oValues, eValues));
+        uint32x4_t deviates = vbicq_u32(vcgtq_f32(absError, vmulq_f32(deviation, absExpect)), equal);
+        if (vmaxvq_u32(deviates) != 0) {
+            uint32_t mask[4];
+            vst1q_u32(mask, deviates);
+            for (uint32_t lane = 0; lane < lanes; lane++) {
+                if (mask[lane] != 0) {
+                    AddMismatch(stats, i + lane);
+                }
+            }
+        }
+        // equal lanes count as 0, the other lanes are finite here
+        float32x4_t relError = vdivq_f32(absError, absExpect);
+        maxAbs = vmaxnmq_f32(maxAbs, vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(absError), equal)));
+        maxRel = vmaxnmq_f32(maxRel, vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(relError), equal)));
+        // the key distance always fits in 32 bits unsigned
+        uint32x4_t ulp = vreinterpretq_u32_s32(vsubq_s32(vmaxq_s32(eKeys, oKeys), vminq_s32(eKeys, oKeys)));
+        for (uint32_t b = 0; b < COMPARE_ULP_BUCKETS - 1; b++) {
+            atLeast[b] = vsubq_u32(atLeast[b], vcgeq_u32(ulp, bounds[b]));
+        }
+        vectorNum += lanes;
+    }
+
+    if (vmaxnmvq_f32(maxAbs) > stats.maxAbsError) {
+        stats.maxAbsError = vmaxnmvq_f32(maxAbs);
+    }
+    if (vmaxnmvq_f32(maxRel) > stats.maxRelError) {
+        stats.maxRelError = vmaxnmvq_f32(maxRel);
+    }
+    uint64_t atLeastNum[COMPARE_ULP_BUCKETS - 1] = {0};
+    for (uint32_t b = 0; b < COMPARE_ULP_BUCKETS - 1; b++) {
+        atLeastNum[b] = vaddlvq_u32(atLeast[b]);
+    }
+    stats.ulpHistogram[0] += vectorNum - atLeastNum[0];
+    for (uint32_t b = 1; b < COMPARE_ULP_BUCKETS - 1; b++) {
+        stats.ulpHistogram[b] += atLeastNum[b - 1] - atLeastNum[b];
+    }
+    stats.ulpHistogram[COMPARE_ULP_BUCKETS - 1] += atLeastNum[COMPARE_ULP_BUCKETS - 2];
+    return blockEnd;
+}
+#endif
+
+static uint64_t CompareVector(const char* e, const char* o, uint64_t elemNum, int32_t dataType,
+                              float precisionDeviation, CompareStats& stats)
+{
+#if defined(COMPARE_AVX2)
+    // checked once, older x86 hosts take the scalar path
+    static const bool avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") &&
+                              __builtin_cpu_supports("f16c"));
+    return avx2 ? CompareAvx2(e, o, elemNum, dataType, precisionDeviation, stats) : 0;
+#elif defined(COMPARE_NEON)
+    return CompareNeon(e, o, elemNum, dataType, precisionDeviation, stats);
+#else
+    return 0;
+#endif
+}
+
+int32_t CompareTensor(const CustomFileBlob& expect, const CustomFileBlob& output, int32_t dataType,
+                      float precisionDeviation, float statisticalDiscrepancy, bool& compareRet,
+                      CompareStats& stats)
+{
+    compareRet = false;
+    stats = CompareStats();
+    uint32_t elemSize = ElemSize(dataType);
+    if (elemSize == 0) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Compare of data type %d is not supported.", dataType);
+        return FAILED;
+    }
+    if (expect.size != output.size || expect.size % elemSize != 0) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Expect has %llu bytes, output has %llu bytes.",
+                        (unsigned long long)expect.size, (unsigned long long)output.size);
+        return FAILED;
+    }
+    if (expect.size > 0 && (expect.data == nullptr || output.data == nullptr)) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Expect or output has no data to compare.");
+        return FAILED;
+    }
+
+    stats.elemNum = expect.size / elemSize;
+    stats.ulpHistogram.assign(COMPARE_ULP_BUCKETS, 0);
+    const char* e = expect.data.get();
+    const char* o = output.data.get();
+    uint64_t done = CompareVector(e, o, stats.elemNum, dataType, precisionDeviation, stats);
+    CompareRange(e, o, done, stats.elemNum, dataType, precisionDeviation, stats);
+    compareRet = (stats.elemNum == 0) || ((double)stats.deviated / stats.elemNum <= statisticalDiscrepancy);
+    return SUCCESS;
+}
+
+int32_t CompareTensor(const CustomFileBlob& expect, const CustomFileBlob& output, int32_t dataType,
+                      float precisionDeviation, float statisticalDiscrepancy, bool& compareRet)
+{
+    CompareStats stats;
+    return CompareTensor(expect, output, dataType, precisionDeviation, statisticalDiscrepancy, compareRet, stats);
+}
+
+std::string CompareStatsText(const CompareStats& stats)
+{
+    std::ostringstream text;
+    text << "deviated " << stats.deviated << "/" << stats.elemNum << ", max abs error " << stats.maxAbsError
+         << ", max rel error " << stats.maxRelError << ", ulp";
+    for (auto count : stats.ulpHistogram) {
+        text << " " << count;
+    }
+    if (!stats.firstMismatches.empty()) {
+        text << ", first mismatches";
+        for (auto index : stats.firstMismatches) {
+            text << " " << index;
+        }
+    }
+    return text.str();
+}
+
+void CompareOutputs(const CustomInfo& customInfo, const std::vector<CustomFileBlob>& outputList,
+                    std::vector<int32_t>& compareResultList, std::vector<CompareStats>& compareStatsList,
+                    WorkerPool& pool)
+{
+    uint32_t outputNum = customInfo.expectFileList.size();
+    compareResultList.assign(outputNum, false);
+    compareStatsList.assign(outputNum, CompareStats());
+    // tapped chain outputs may follow the compared ones
+    if (outputList.size() < outputNum || customInfo.dataTypeList.size() < outputNum) {
+        HIAI_ENGINE_LOG(HIAI_IDE_ERROR, "Expect output file number: %d != actual output file number: %d.",
+                        outputNum, outputList.size());
+        return;
+    }
+    auto compareOne = [&customInfo, &outputList, &compareResultList, &compareStatsList](uint32_t i) {
+        bool compareRet = false;
+        if (CompareTensor(customInfo.expectFileList[i], outputList[i], customInfo.dataTypeList[i],
+                          customInfo.precisionDeviation, customInfo.statisticalDiscrepancy, compareRet,
+                          compareStatsList[i]) == SUCCESS) {
+            compareResultList[i] = compareRet;
+        }
+        HIAI_ENGINE_LOG(HIAI_IDE_INFO, "Host compare result of output %u: %s, %s.", i, compareRet ? "true" : "false",
+                        CompareStatsText(compareStatsList[i]).c_str());
+    };
+    pool.ParallelFor(outputNum, compareOne);
+}
@@ -0,0 +1,856 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#include "test_spec.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <sstream>
+#include "custom_common.h"
+
+#define SUCCESS 0
+#define FAILED -1
+
+const JsonValue* JsonValue::Find(const std::string& key) const
+{
+    if (type != JSON_OBJECT) {
+        return nullptr;
+    }
+    for (auto& member : object) {
+        if (member.first == key) {
+            return &member.second;
+        }
+    }
+    return nullptr;
+}
+
+class JsonParser
+{
+public:
+    JsonParser(const std::string& text) : text(text), pos(0) {}
+
+    int Parse(JsonValue& root, std::string& errorMsg)
+    {
+        if (ParseValue(root, 0) != SUCCESS || (SkipSpace(), pos != text.length())) {
+            std::ostringstream ss;
+            ss << "invalid JSON near offset " << pos;
+            errorMsg = ss.str();
+            return FAILED;
+        }
+        return SUCCESS;
+    }
+
+private:
+    static const int MAX_DEPTH = 64;
+
+    void SkipSpace()
+    {
+        while (pos < text.length() && strchr(" \t\r\n", text[pos]) != NULL) {
+            pos++;
+        }
+    }
+
+    bool Consume(const char* word)
+    {
+        size_t len = strlen(word);
+        if (text.compare(pos, len, word) != 0) {
+            return false;
+        }
+        pos += len;
+        return true;
+    }
+
+    int ParseString(std::string& out)
+    {
+        if (text[pos] != '"') {
+            return FAILED;
+        }
+        pos++;
+        while (pos < text.length() && text[pos] != '"') {
+            char c = text[pos++];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.length()) {
+                return FAILED;
+            }
+            char e = text[pos++];
+            switch (e) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u':
+                    // only ASCII escapes are expected in paths and names
+                    if (pos + 4 > text.length()) {
+                        return FAILED;
+                    }
+                    out += static_cast<char>(strtol(text.substr(pos, 4).c_str(), NULL, 16) & 0x7f);
+                    pos += 4;
+                    break;
+                default: out += e; break;
+            }
+        }
+        if (pos >= text.length()) {
+            return FAILED;
+        }
+        pos++;
+        return SUCCESS;
+    }
+
+    int ParseNumber(JsonValue& value)
+    {
+        const char* begin = text.c_str() + pos;
+        char* end = NULL;
+        value.number = strtod(begin, &end);
+        if (end == begin) {
+            return FAILED;
+        }
+        value.type = JsonValue::JSON_NUMBER;
+        pos += end - begin;
+        return SUCCESS;
+    }
+
+    int ParseValue(JsonValue& value, int depth)
+    {
+        SkipSpace();
+        if (pos >= text.length() || depth > MAX_DEPTH) {
+            return FAILED;
+        }
+        char c = text[pos];
+        if (c == '{') {
+            pos++;
+            value.type = JsonValue::JSON_OBJECT;
+            SkipSpace();
+            if (pos < text.length() && text[pos] == '}') {
+                pos++;
+                return SUCCESS;
+            }
+            while (true) {
+                std::pair<std::string, JsonValue> member;
+                SkipSpace();
+                if (pos >= text.length() || ParseString(member.first) != SUCCESS) {
+                    return FAILED;
+                }
+                SkipSpace();
+                if (!Consume(":") || ParseValue(member.second, depth + 1) != SUCCESS) {
+                    return FAILED;
+                }
+                value.object.push_back(member);
+                SkipSpace();
+                if (Consume("}")) {
+                    return SUCCESS;
+                }
+                if (!Consume(",")) {
+                    return FAILED;
+                }
+            }
+        }
+        if (c == '[') {
+            pos++;
+            value.type = JsonValue::JSON_ARRAY;
+            SkipSpace();
+            if (pos < text.length() && text[pos] == ']') {
+                pos++;
+                return SUCCESS;
+            }
+            while (true) {
+                JsonValue element;
+                if (ParseValue(element, depth + 1) != SUCCESS) {
+                    return FAILED;
+                }
+                value.array.push_back(element);
+                SkipSpace();
+                if (Consume("]")) {
+                    return SUCCESS;
+                }
+                if (!Consume(",")) {
+                    return FAILED;
+                }
+            }
+        }
+        if (c == '"') {
+            value.type = JsonValue::JSON_STRING;
+            return ParseString(value.str);
+        }
+        if (Consume("true")) {
+            value.type = JsonValue::JSON_BOOL;
+            value.boolean = true;
+            return SUCCESS;
+        }
+        if (Consume("false")) {
+            value.type = JsonValue::JSON_BOOL;
+            return SUCCESS;
+        }
+        if (Consume("null")) {
+            value.type = JsonValue::JSON_NULL;
+            return SUCCESS;
+        }
+        return ParseNumber(value);
+    }
+
+    const std::string& text;
+    size_t pos;
+};
+
+int ParseJson(const std::string& text, JsonValue& root, std::string& errorMsg)
+{
+    JsonParser parser(text);
+    return parser.Parse(root, errorMsg);
+}
+
+struct DtypeInfo
+{
+    const char* name;
+    uint32_t elemSize;
+    int32_t dataType;  // CompareDataType, -1 if outputs of this dtype can not be compared
+    int32_t elemType;  // GeneratorElemType, -1 if inputs of this dtype can not be generated
+};
+
+static const DtypeInfo DTYPE_TABLE[] = {
+    {"float32", 4, COMPARE_FP32, GEN_FLOAT32},
+    {"float16", 2, COMPARE_FP16, GEN_FLOAT16},
+    {"int8", 1, COMPARE_INT8, GEN_INT8},
+    {"uint8", 1, -1, GEN_UINT8},
+    {"int32", 4, COMPARE_INT32, GEN_INT32},
+    {"bfloat16", 2, COMPARE_BF16, -1},
+};
+
+struct DistributionInfo
+{
+    const char* name;
+    int32_t distribution;
+    const char* param0;
+    const char* param1;
+    float default0;
+    float default1;
+};
+
+static const DistributionInfo DISTRIBUTION_TABLE[] = {
+    {"uniform", GEN_UNIFORM, "low", "high", 0, 1},
+    {"normal", GEN_NORMAL, "mean", "stddev", 0, 1},
+    {"constant", GEN_CONSTANT, "value", "", 0, 0},
+    {"ramp", GEN_RAMP, "start", "step", 0, 1},
+};
+
+struct LayoutInfo
+{
+    const char* name;
+    uint32_t rank;  // dims the shape must have, 0 for any
+    uint32_t c0Bytes;  // bytes of the innermost C0 dim, 0 if the layout has none
+};
+
+static const LayoutInfo LAYOUT_TABLE[] = {
+    {"ND", 0, 0},
+    {"NCHW", 4, 0},
+    {"NHWC", 4, 0},
+    {"NC1HWC0", 5, 32},
+};
+
+static int GetString(const JsonValue& node, const char* key, std::string& out, bool required, FILE *stream)
+{
+    const JsonValue* value = node.Find(key);
+    if (value == nullptr) {
+        if (required) {
+            fprintf(stream, "[Error] Spec misses \"%s\".\n", key);
+            return FAILED;
+        }
+        return SUCCESS;
+    }
+    if (value->type != JsonValue::JSON_STRING) {
+        fprintf(stream, "[Error] Spec \"%s\" should be a string.\n", key);
+        return FAILED;
+    }
+    out = value->str;
+    return SUCCESS;
+}
+
+static int GetNumber(const JsonValue& node, const char* key, double& out, FILE *stream)
+{
+    const JsonValue* value = node.Find(key);
+    if (value == nullptr) {
+        return SUCCESS;
+    }
+    if (value->type != JsonValue::JSON_NUMBER) {
+        fprintf(stream, "[Error] Spec \"%s\" should be a number.\n", key);
+        return FAILED;
+    }
+    out = value->number;
+    return SUCCESS;
+}
+
+// "generator": {"distribution": "uniform", "seed": 1, "low": -1, "high": 1}
+static int ParseGenerator(const JsonValue& node, InputGenerator& generator, FILE *stream)
+{
+    std::string distribution;
+    double seed = 0;
+    if (node.type != JsonValue::JSON_OBJECT || GetString(node, "distribution", distribution, true, stream) != SUCCESS ||
+        GetNumber(node, "seed", seed, stream) != SUCCESS) {
+        fprintf(stream, "[Error] Spec generator should be an object with \"distribution\".\n");
+        return FAILED;
+    }
+    if (seed < 0 || seed != (uint64_t)seed) {
+        fprintf(stream, "[Error] Spec generator seed should be a non-negative integer.\n");
+        return FAILED;
+    }
+    for (auto& info : DISTRIBUTION_TABLE) {
+        if (distribution != info.name) {
+            continue;
+        }
+        double param0 = info.default0;
+        double param1 = info.default1;
+        if (GetNumber(node, info.param0, param0, stream) != SUCCESS ||
+            (info.param1[0] != '\0' && GetNumber(node, info.param1, param1, stream) != SUCCESS)) {
+            return FAILED;
+        }
+        generator.distribution = info.distribution;
+        generator.seed = (uint64_t)seed;
+        generator.param0 = param0;
+        generator.param1 = param1;
+        return SUCCESS;
+    }
+    fprintf(stream, "[Error] Spec distribution %s is not supported, use uniform, normal, constant or ramp.\n",
+            distribution.c_str());
+    return FAILED;
+}
+
+enum TensorRole
+{
+    ROLE_INPUT,         // file or generator
+    ROLE_STAGE_INPUT,   // chain stage input, file or "from" an output of the previous stage
+    ROLE_OUTPUT,        // final output, may have "expect"
+    ROLE_TAP_OUTPUT     // intermediate chain output, returned only if it has a path
+};
+
+static int ParseTensor(const JsonValue& node, TensorRole role, TensorSpec& tensor, FILE *stream)
+{
+    if (node.type != JsonValue::JSON_OBJECT) {
+        fprintf(stream, "[Error] Spec tensor should be an object.\n");
+        return FAILED;
+    }
+    const JsonValue* generator = node.Find("generator");
+    if (role != ROLE_INPUT && generator != nullptr) {
+        fprintf(stream, "[Error] Only inputs of the first kernel can have \"generator\".\n");
+        return FAILED;
+    }
+    if (generator != nullptr && ParseGenerator(*generator, tensor.generator, stream) != SUCCESS) {
+        return FAILED;
+    }
+    const JsonValue* from = node.Find("from");
+    if (from != nullptr && (role != ROLE_STAGE_INPUT || from->type != JsonValue::JSON_NUMBER || from->number < 0 ||
+                            from->number != (int32_t)from->number)) {
+        fprintf(stream, "[Error] Spec \"from\" should be an output index of the previous chain stage.\n");
+        return FAILED;
+    }
+    tensor.from = (from != nullptr) ? (int32_t)from->number : -1;
+    bool pathRequired = (role == ROLE_OUTPUT) || (role == ROLE_INPUT && generator == nullptr) ||
+                        (role == ROLE_STAGE_INPUT && from == nullptr);
+    if (GetString(node, "path", tensor.path, pathRequired, stream) != SUCCESS ||
+        GetString(node, "dtype", tensor.dtype, false, stream) != SUCCESS ||
+        GetString(node, "layout", tensor.layout, false, stream) != SUCCESS ||
+        GetString(node, "expect", tensor.expect, false, stream) != SUCCESS) {
+        return FAILED;
+    }
+    if (role != ROLE_OUTPUT && !tensor.expect.empty()) {
+        fprintf(stream, "[Error] Spec tensor %s should not have \"expect\", only final outputs are compared.\n",
+                tensor.path.c_str());
+        return FAILED;
+    }
+
+    const DtypeInfo* dtype = nullptr;
+    for (auto& info : DTYPE_TABLE) {
+        if (tensor.dtype == info.name) {
+            dtype = &info;
+        }
+    }
+    if (dtype == nullptr) {
+        fprintf(stream, "[Error] Spec dtype %s of %s is not supported.\n", tensor.dtype.c_str(), tensor.path.c_str());
+        return FAILED;
+    }
+    tensor.elemSize = dtype->elemSize;
+    tensor.dataType = dtype->dataType;
+    if (!tensor.expect.empty() && tensor.dataType < 0) {
+        fprintf(stream, "[Error] Compare of dtype %s is not supported.\n", tensor.dtype.c_str());
+        return FAILED;
+    }
+
+    const JsonValue* shape = node.Find("shape");
+    if (shape == nullptr || shape->type != JsonValue::JSON_ARRAY) {
+        fprintf(stream, "[Error] Spec tensor %s misses \"shape\".\n", tensor.path.c_str());
+        return FAILED;
+    }
+    tensor.size = tensor.elemSize;
+    for (auto& dim : shape->array) {
+        if (dim.type != JsonValue::JSON_NUMBER || dim.number < 0 || dim.number != (int64_t)dim.number) {
+            fprintf(stream, "[Error] Spec tensor %s has an illegal dim.\n", tensor.path.c_str());
+            return FAILED;
+        }
+        uint64_t dimSize = (uint64_t)dim.number;
+        if (dimSize != 0 && tensor.size > UINT64_MAX / dimSize) {
+            fprintf(stream, "[Error] Spec tensor %s has more bytes than fit in 64 bits.\n", tensor.path.c_str());
+            return FAILED;
+        }
+        tensor.shape.push_back((int64_t)dim.number);
+        tensor.size *= dimSize;
+    }
+
+    const LayoutInfo* layout = nullptr;
+    for (auto& info : LAYOUT_TABLE) {
+        if (tensor.layout == info.name) {
+            layout = &info;
+        }
+    }
+    if (layout == nullptr) {
+        fprintf(stream, "[Error] Spec layout %s of %s is not supported, use ND, NCHW, NHWC or NC1HWC0.\n",
+                tensor.layout.c_str(), tensor.path.c_str());
+        return FAILED;
+    }
+    if (layout->rank != 0 && tensor.shape.size() != layout->rank) {
+        fprintf(stream, "[Error] Spec tensor %s of layout %s should have %u dims.\n", tensor.path.c_str(),
+                layout->name, layout->rank);
+        return FAILED;
+    }
+    // C0 fills one 32 byte block, 16 float16 or 32 int8 elements
+    if (layout->c0Bytes != 0 && (uint64_t)tensor.shape.back() * tensor.elemSize != layout->c0Bytes) {
+        fprintf(stream, "[Error] Spec tensor %s of layout %s should have a C0 dim of %u bytes.\n",
+                tensor.path.c_str(), layout->name, layout->c0Bytes);
+        return FAILED;
+    }
+    if (generator != nullptr) {
+        if (dtype->elemType < 0) {
+            fprintf(stream, "[Error] Generating dtype %s is not supported.\n", tensor.dtype.c_str());
+            return FAILED;
+        }
+        tensor.generator.elemType = dtype->elemType;
+        tensor.generator.elemNum = tensor.size / tensor.elemSize;
+    }
+    return SUCCESS;
+}
+
+static int CheckFileSize(const std::string& fileName, uint64_t size, FILE *stream)
+{
+    struct stat fileStat;
+    if (stat(fileName.c_str(), &fileStat) != 0) {
+        fprintf(stream, "[Error] Open file %s failed.\n", fileName.c_str());
+        return FAILED;
+    }
+    if (S_ISREG(fileStat.st_mode) && (uint64_t)fileStat.st_size != size) {
+        fprintf(stream, "[Error] File %s has %llu bytes, but its shape needs %llu bytes.\n", fileName.c_str(),
+                (unsigned long long)fileStat.st_size, (unsigned long long)size);
+        return FAILED;
+    }
+    return SUCCESS;
+}
+
+static int ParseTensorList(const JsonValue& node, const char* key, TensorRole role, std::vector<TensorSpec>& tensors,
+                           FILE *stream)
+{
+    const JsonValue* list = node.Find(key);
+    if (list == nullptr || list->type != JsonValue::JSON_ARRAY || list->array.empty()) {
+        fprintf(stream, "[Error] Spec \"%s\" should be a non-empty array.\n", key);
+        return FAILED;
+    }
+    for (auto& element : list->array) {
+        TensorSpec tensor;
+        if (ParseTensor(element, role, tensor, stream) != SUCCESS) {
+            return FAILED;
+        }
+        tensors.push_back(tensor);
+    }
+    return SUCCESS;
+}
+
+static int ParseKernelType(const JsonValue& node, int32_t& type, FILE *stream)
+{
+    double value = type;
+    if (GetNumber(node, "type", value, stream) != SUCCESS) {
+        return FAILED;
+    }
+    if (value != 0 && value != 1 && value != 2) {
+        fprintf(stream, "[Error] Spec type should be 0, 1 or 2.\n");
+        return FAILED;
+    }
+    type = (int32_t)value;
+    return SUCCESS;
+}
+
+// "workspaces": [bytes, ...], scratch memory handed to the kernel on every run
+static int ParseWorkspaces(const JsonValue& node, std::vector<uint64_t>& workspaces, FILE *stream)
+{
+    const JsonValue* list = node.Find("workspaces");
+    if (list == nullptr) {
+        return SUCCESS;
+    }
+    if (list->type != JsonValue::JSON_ARRAY) {
+        fprintf(stream, "[Error] Spec \"workspaces\" should be an array of sizes.\n");
+        return FAILED;
+    }
+    for (auto& size : list->array) {
+        if (size.type != JsonValue::JSON_NUMBER || size.number <= 0 || size.number > UINT32_MAX ||
+            size.number != (uint64_t)size.number) {
+            fprintf(stream, "[Error] Spec workspace sizes should be integers from 1 to %u.\n", UINT32_MAX);
+            return FAILED;
+        }
+        workspaces.push_back((uint64_t)size.number);
+    }
+    return SUCCESS;
+}
+
+static int ParseChain(const JsonValue& root, TestSpec& spec, FILE *stream)
+{
+    const JsonValue* chain = root.Find("chain");
+    if (chain == nullptr) {
+        return SUCCESS;
+    }
+    if (chain->type != JsonValue::JSON_ARRAY || chain->array.empty()) {
+        fprintf(stream, "[Error] Spec \"chain\" should be a non-empty array of stages.\n");
+        return FAILED;
+    }
+    const std::vector<TensorSpec>* prevOutputs = &spec.outputs;
+    for (uint32_t s = 0; s < chain->array.size(); s++) {
+        const JsonValue& node = chain->array[s];
+        bool last = (s + 1 == chain->array.size());
+        StageSpec stage;
+        if (node.type != JsonValue::JSON_OBJECT ||
+            GetString(node, "kernelName", stage.kernelName, true, stream) != SUCCESS ||
+            GetString(node, "binFile", stage.binFile, true, stream) != SUCCESS ||
+            ParseKernelType(node, stage.type, stream) != SUCCESS ||
+            ParseTensorList(node, "inputs", ROLE_STAGE_INPUT, stage.inputs, stream) != SUCCESS ||
+            ParseTensorList(node, "outputs", last ? ROLE_OUTPUT : ROLE_TAP_OUTPUT, stage.outputs, stream) != SUCCESS ||
+            ParseWorkspaces(node, stage.workspaces, stream) != SUCCESS) {
+            fprintf(stream, "[Error] Spec chain stage %u is illegal.\n", s + 1);
+            return FAILED;
+        }
+        for (auto& input : stage.inputs) {
+            if (input.from < 0) {
+                continue;
+            }
+            if ((uint32_t)input.from >= prevOutputs->size() || (*prevOutputs)[input.from].size != input.size) {
+                fprintf(stream, "[Error] Chain stage %u input from output %d does not match the previous stage.\n",
+                        s + 1, input.from);
+                return FAILED;
+            }
+        }
+        spec.chain.push_back(stage);
+        prevOutputs = &spec.chain.back().outputs;
+    }
+    return SUCCESS;
+}
+
+static int LoadJsonObject(const std::string& fileName, JsonValue& root, FILE *stream)
+{
+    std::ifstream file(fileName);
+    if (file.fail()) {
+        fprintf(stream, "[Error] Open spec %s failed.\n", fileName.c_str());
+        return FAILED;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+
+    std::string errorMsg;
+    if (ParseJson(text.str(), root, errorMsg) != SUCCESS || root.type != JsonValue::JSON_OBJECT) {
+        fprintf(stream, "[Error] Spec %s: %s.\n", fileName.c_str(), errorMsg.empty() ? "not an object" :
+                errorMsg.c_str());
+        return FAILED;
+    }
+    return SUCCESS;
+}
+
+int LoadTestSpec(const std::string& fileName, TestSpec& spec, FILE *stream)
+{
+    JsonValue root;
+    if (LoadJsonObject(fileName, root, stream) != SUCCESS) {
+        return FAILED;
+    }
+
+    double precisionDeviation = spec.precisionDeviation;
+    double statisticalDiscrepancy = spec.statisticalDiscrepancy;
+    if (GetString(root, "kernelName", spec.kernelName, true, stream) != SUCCESS ||
+        GetString(root, "binFile", spec.binFile, true, stream) != SUCCESS ||
+        ParseKernelType(root, spec.type, stream) != SUCCESS ||
+        GetNumber(root, "precisionDeviation", precisionDeviation, stream) != SUCCESS ||
+        GetNumber(root, "statisticalDiscrepancy", statisticalDiscrepancy, stream) != SUCCESS) {
+        return FAILED;
+    }
+    if (precisionDeviation < 0 || precisionDeviation > 1 || statisticalDiscrepancy < 0 || statisticalDiscrepancy > 1) {
+        fprintf(stream, "[Error] Spec tolerances should be in [0, 1].\n");
+        return FAILED;
+    }
+    spec.precisionDeviation = precisionDeviation;
+    spec.statisticalDiscrepancy = statisticalDiscrepancy;
+
+    bool chained = (root.Find("chain") != nullptr);
+    if (ParseTensorList(root, "inputs", ROLE_INPUT, spec.inputs, stream) != SUCCESS ||
+        ParseTensorList(root, "outputs", chained ? ROLE_TAP_OUTPUT : ROLE_OUTPUT, spec.outputs, stream) != SUCCESS ||
+        ParseWorkspaces(root, spec.workspaces, stream) != SUCCESS || ParseChain(root, spec, stream) != SUCCESS) {
+        return FAILED;
+    }
+
+    // every file that will be read must match its shape
+    std::vector<const std::vector<TensorSpec>*> inputLists = {&spec.inputs};
+    std::vector<const std::vector<TensorSpec>*> outputLists = {&spec.outputs};
+    for (auto& stage : spec.chain) {
+        inputLists.push_back(&stage.inputs);
+        outputLists.push_back(&stage.outputs);
+    }
+    for (auto inputs : inputLists) {
+        for (auto& input : *inputs) {
+            if (input.generator.distribution == GEN_NONE && input.from < 0 &&
+                CheckFileSize(input.path, input.size, stream) != SUCCESS) {
+                return FAILED;
+            }
+        }
+    }
+    for (auto outputs : outputLists) {
+        for (auto& output : *outputs) {
+            if (!output.expect.empty() && CheckFileSize(output.expect, output.size, stream) != SUCCESS) {
+                return FAILED;
+            }
+        }
+    }
+    return SUCCESS;
+}
+
+static const char* SWEEP_REDUCTION_OPS[] = {"SUM", "ASUM", "SUMSQ", "MEAN"};
+static const uint32_t CONV_DIMS = 9;  // N, Cin, H, W, Cout, KH, KW, stride, pad
+// limits of custom_convolution/operator/custom_convolution.py
+static const int64_t CONV_PAD_MAX = 255;
+static const int64_t CONV_FILTER_HW_MAX = 255;
+static const int64_t CONV_STRIDE_MAX = 63;
+static const double CONV_FMAP_LIMIT = 2147483647.0;  // feature maps stay below 2^31 - 1 elements
+static const int64_t CONV_L1_BUFFER_BYTES = 1024 * 1024;  // L1_Buffer of the Ascend 310 AI Core
+static const uint32_t MAX_SWEEP_SHAPES = 100000;
+
+static int ParseDims(const JsonValue& node, std::vector<int64_t>& dims, FILE *stream)
+{
+    if (node.type != JsonValue::JSON_ARRAY || node.array.empty()) {
+        fprintf(stream, "[Error] Sweep shape should be a non-empty array of dims.\n");
+        return FAILED;
+    }
+    for (auto& dim : node.array) {
+        if (dim.type != JsonValue::JSON_NUMBER || dim.number < 0 || dim.number != (int64_t)dim.number) {
+            fprintf(stream, "[Error] Sweep shape has an illegal dim.\n");
+            return FAILED;
+        }
+        dims.push_back((int64_t)dim.number);
+    }
+    return SUCCESS;
+}
+
+// "grid": [[1, 8], [16, 32], ...], every combination of one value per dim, last dim fastest
+static int ParseGrid(const JsonValue& node, std::vector<std::vector<int64_t> >& shapes, FILE *stream)
+{
+    std::vector<std::vector<int64_t> > values;
+    uint64_t combinations = 1;
+    for (auto& dimValues : node.array) {
+        std::vector<int64_t> dims;
+        if (ParseDims(dimValues, dims, stream) != SUCCESS) {
+            return FAILED;
+        }
+        combinations *= dims.size();
+        if (combinations > MAX_SWEEP_SHAPES) {
+            fprintf(stream, "[Error] Sweep grid has more than %u shapes.\n", MAX_SWEEP_SHAPES);
+            return FAILED;
+        }
+        values.push_back(dims);
+    }
+    std::vector<size_t> pick(values.size(), 0);
+    for (uint64_t n = 0; n < combinations && !values.empty(); n++) {
+        std::vector<int64_t> shape;
+        for (size_t d = 0; d < values.size(); d++) {
+            shape.push_back(values[d][pick[d]]);
+        }
+        shapes.push_back(shape);
+        for (size_t d = values.size(); d-- > 0;) {
+            if (++pick[d] < values[d].size()) {
+                break;
+            }
+            pick[d] = 0;
+        }
+    }
+    return SUCCESS;
+}
+
+// the sample reduction only takes float16 and float32 and an axis inside the shape
+static int CheckReductionShape(const SweepSpec& spec, const std::vector<int64_t>& shape, FILE *stream)
+{
+    int32_t rank = (int32_t)shape.size();
+    if (spec.axis >= rank || spec.axis < -rank) {
+        fprintf(stream, "[Error] Sweep axis %d is out of range for a shape of %d dims.\n", spec.axis, rank);
+        return FAILED;
+    }
+    for (auto dim : shape) {
+        if (dim == 0) {
+            fprintf(stream, "[Error] Sweep shape should not have a zero dim.\n");
+            return FAILED;
+        }
+    }
+    return SUCCESS;
+}
+
+// mirrors conv_check_rule and the pad, filter and stride ranges of the custom_convolution operator,
+// so the sweep never asks for a kernel the operator refuses to build
+static int CheckConvShape(const SweepSpec& spec, const std::vector<int64_t>& shape, FILE *stream)
+{
+    if (shape.size() != CONV_DIMS) {
+        fprintf(stream, "[Error] Sweep conv shape should be [N, Cin, H, W, Cout, KH, KW, stride, pad].\n");
+        return FAILED;
+    }
+    for (uint32_t d = 0; d + 1 < CONV_DIMS; d++) {
+        if (shape[d] == 0) {
+            fprintf(stream, "[Error] Sweep conv shape should only have a zero pad.\n");
+            return FAILED;
+        }
+    }
+    int64_t pad = shape[8];
+    if (shape[5] > shape[2] + 2 * pad || shape[6] > shape[3] + 2 * pad || pad >= shape[5] || pad >= shape[6]) {
+        fprintf(stream, "[Error] Sweep conv kernel %lldx%lld does not fit input %lldx%lld with pad %lld.\n",
+                (long long)shape[5], (long long)shape[6], (long long)shape[2], (long long)shape[3],
+                (long long)pad);
+        return FAILED;
+    }
+    int64_t stride = shape[7];
+    if (pad > CONV_PAD_MAX || shape[5] > CONV_FILTER_HW_MAX || shape[6] > CONV_FILTER_HW_MAX ||
+        stride > CONV_STRIDE_MAX) {
+        fprintf(stream, "[Error] Sweep conv needs pad <= %lld, kernel <= %lld and stride <= %lld.\n",
+                (long long)CONV_PAD_MAX, (long long)CONV_FILTER_HW_MAX, (long long)CONV_STRIDE_MAX);
+        return FAILED;
+    }
+
+    // CUBE_MKN ci0 of the weight dtype and bytes of one feature map element
+    int64_t ci0 = (spec.dtype == "float32") ? 8 : 16;
+    int64_t elemBytes = (spec.dtype == "float32") ? 4 : 2;
+    int64_t ci1 = (shape[1] + ci0 - 1) / ci0;
+    int64_t hi = shape[2];
+    int64_t wi = shape[3];
+    int64_t ho = (hi + 2 * pad - shape[5]) / stride + 1;
+    int64_t wo = (wi + 2 * pad - shape[6]) / stride + 1;
+    // load3d of the first 16 output rows needs this much of the padded input in L1
+    int64_t rows = (16 + wo - 1) / wo;
+    double featureMapBytes = (double)ci0 * (rows * stride + shape[5]) * (wi + 2 * pad) * 2 * elemBytes;
+    if (featureMapBytes > CONV_L1_BUFFER_BYTES) {
+        fprintf(stream, "[Error] Sweep conv shape overflows the %lld byte L1 buffer.\n",
+                (long long)CONV_L1_BUFFER_BYTES);
+        return FAILED;
+    }
+    // products in double, the dims are not bounded and must not wrap before the compare
+    if ((double)shape[0] * wo * ho * shape[4] >= CONV_FMAP_LIMIT) {
+        fprintf(stream, "[Error] Sweep conv output feature map exceeds 32-bit limitations.\n");
+        return FAILED;
+    }
+    if ((double)shape[0] * hi * wi * ci1 * ci0 >= CONV_FMAP_LIMIT) {
+        fprintf(stream, "[Error] Sweep conv input feature map exceeds 32-bit limitations.\n");
+        return FAILED;
+    }
+    return SUCCESS;
+}
+
+int LoadSweepSpec(const std::string& fileName, SweepSpec& spec, FILE *stream)
+{
+    JsonValue root;
+    if (LoadJsonObject(fileName, root, stream) != SUCCESS) {
+        return FAILED;
+    }
+    std::string kernel;
+    double axis = spec.axis;
+    double coeff = spec.coeff;
+    double warmup = spec.warmup;
+    double repeat = spec.repeat;
+    if (GetString(root, "kernel", kernel, true, stream) != SUCCESS ||
+        GetString(root, "kernelName", spec.kernelName, true, stream) != SUCCESS ||
+        GetString(root, "binFile", spec.binFile, true, stream) != SUCCESS ||
+        ParseKernelType(root, spec.type, stream) != SUCCESS ||
+        GetString(root, "dtype", spec.dtype, false, stream) != SUCCESS ||
+        GetString(root, "op", spec.op, false, stream) != SUCCESS ||
+        GetString(root, "report", spec.report, false, stream) != SUCCESS ||
+        GetNumber(root, "axis", axis, stream) != SUCCESS || GetNumber(root, "coeff", coeff, stream) != SUCCESS ||
+        GetNumber(root, "warmup", warmup, stream) != SUCCESS || GetNumber(root, "repeat", repeat, stream) != SUCCESS ||
+        GetNumber(root, "peakGflops", spec.peakGflops, stream) != SUCCESS ||
+        GetNumber(root, "peakGBps", spec.peakGBps, stream) != SUCCESS) {
+        return FAILED;
+    }
+    if (kernel == "reduction") {
+        spec.kernel = SWEEP_REDUCTION;
+    } else if (kernel == "conv") {
+        spec.kernel = SWEEP_CONV;
+    } else {
+        fprintf(stream, "[Error] Sweep kernel %s is not supported, use reduction or conv.\n", kernel.c_str());
+        return FAILED;
+    }
+    if (axis != (int32_t)axis || warmup < 0 || warmup != (uint32_t)warmup || repeat < 1 ||
+        repeat != (uint32_t)repeat || spec.peakGflops < 0 || spec.peakGBps < 0) {
+        fprintf(stream, "[Error] Sweep axis, warmup, repeat and peaks should be integers, repeat at least 1.\n");
+        return FAILED;
+    }
+    spec.axis = (int32_t)axis;
+    spec.coeff = coeff;
+    spec.warmup = (uint32_t)warmup;
+    spec.repeat = (uint32_t)repeat;
+    bool opFound = false;
+    for (auto op : SWEEP_REDUCTION_OPS) {
+        opFound = opFound || (spec.op == op);
+    }
+    if (spec.kernel == SWEEP_REDUCTION && !opFound) {
+        fprintf(stream, "[Error] Sweep op can only be one of SUM, ASUM, SUMSQ, MEAN.\n");
+        return FAILED;
+    }
+
+    const DtypeInfo* dtype = nullptr;
+    for (auto& info : DTYPE_TABLE) {
+        if (spec.dtype == info.name) {
+            dtype = &info;
+        }
+    }
+    if (dtype == nullptr || (dtype->elemType != GEN_FLOAT16 && dtype->elemType != GEN_FLOAT32)) {
+        fprintf(stream, "[Error] Sweep only supports float16 and float32 while dtype is %s.\n", spec.dtype.c_str());
+        return FAILED;
+    }
+    spec.elemSize = dtype->elemSize;
+    spec.generator.distribution = GEN_UNIFORM;
+    spec.generator.param0 = -1;
+    spec.generator.param1 = 1;
+    const JsonValue* generator = root.Find("generator");
+    if (generator != nullptr && ParseGenerator(*generator, spec.generator, stream) != SUCCESS) {
+        return FAILED;
+    }
+    spec.generator.elemType = dtype->elemType;
+
+    const JsonValue* shapes = root.Find("shapes");
+    const JsonValue* grid = root.Find("grid");
+    if ((shapes != nullptr && shapes->type != JsonValue::JSON_ARRAY) ||
+        (grid != nullptr && (grid->type != JsonValue::JSON_ARRAY || grid->array.empty()))) {
+        fprintf(stream, "[Error] Sweep \"shapes\" should be a list of shapes, \"grid\" a list of values per dim.\n");
+        return FAILED;
+    }
+    for (uint32_t i = 0; shapes != nullptr && i < shapes->array.size(); i++) {
+        std::vector<int64_t> shape;
+        if (ParseDims(shapes->array[i], shape, stream) != SUCCESS) {
+            return FAILED;
+        }
+        spec.shapes.push_back(shape);
+    }
+    if (grid != nullptr && ParseGrid(*grid, spec.shapes, stream) != SUCCESS) {
+        return FAILED;
+    }
+    if (spec.shapes.empty() || spec.shapes.size() > MAX_SWEEP_SHAPES) {
+        fprintf(stream, "[Error] Sweep should have 1 to %u shapes from \"shapes\" or \"grid\".\n",
+                MAX_SWEEP_SHAPES);
+        return FAILED;
+    }
+    for (auto& shape : spec.shapes) {
+        int checked = (spec.kernel == SWEEP_REDUCTION) ? CheckReductionShape(spec, shape, stream) :
+                      CheckConvShape(spec, shape, stream);
+        if (checked != SUCCESS) {
+            return FAILED;
+        }
+    }
+    return SUCCESS;
+}
@@ -0,0 +1,87 @@
+/**
+ * *
+ * * Copyright(c)<2018>, <Huawei Technologies Co.,Ltd>
+ * *
+ * * @version 1.0
+ * *
+ * * @date 2018-5-19
+ * */
+#include "worker_pool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(uint32_t maxThreads)
+{
+    uint32_t threadNum = std::min(maxThreads, std::max(std::thread::hardware_concurrency(), 1U));
+    for (uint32_t i = 0; i < threadNum; i++) {
+        threads.push_back(std::thread(&WorkerPool::Work, this));
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::unique_lock <std::mutex> lck(mutex);
+        stopping = true;
+    }
+    jobCv.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::RunJob(Job& job)
+{
+    uint32_t i = 0;
+    while ((i = job.next++) < job.count) {
+        (*job.task)(i);
+        if (--job.remaining == 0) {
+            std::unique_lock <std::mutex> lck(mutex);
+            doneCv.notify_all();
+        }
+    }
+}
+
+void WorkerPool::Work()
+{
+    std::unique_lock <std::mutex> lck(mutex);
+    while (true) {
+        jobCv.wait(lck, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty()) {
+            return;
+        }
+        std::shared_ptr<Job> job = jobs.front();
+        if (job->next >= job->count) {
+            // every iteration is handed out, the ones still running finish without the queue
+            jobs.pop_front();
+            continue;
+        }
+        lck.unlock();
+        RunJob(*job);
+        lck.lock();
+    }
+}
+
+void WorkerPool::ParallelFor(uint32_t count, const std::function<void(uint32_t)>& task)
+{
+    if (count == 0) {
+        return;
+    }
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->task = &task;
+    job->count = count;
+    job->remaining = count;
+    if (count > 1 && !threads.empty()) {
+        {
+            std::unique_lock <std::mutex> lck(mutex);
+            jobs.push_back(job);
+        }
+        jobCv.notify_all();
+    }
+    RunJob(*job);
+    std::unique_lock <std::mutex> lck(mutex);
+    auto it = std::find(jobs.begin(), jobs.end(), job);
+    if (it != jobs.end()) {
+        jobs.erase(it);
+    }
+    doneCv.wait(lck, [&job] { return job->remaining == 0; });
+}